@@ -0,0 +1,33 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "fourier.h"
+
+// headless 2D batch over a file of polylines, split across worker processes
+// input: one polyline per line as x y pairs (whitespace or comma separated), blank lines and # comments skipped
+// output: one line per polyline in input order - "index K" then the 2K+1 descriptors as "re im" for k = -K..K
+//   K is 0 (no descriptors) for lines with fewer than two points or junk in them
+//
+// the coordinator cuts the file into byte ranges (a line belongs to the shard its first byte is in), forks the
+// workers and hands shards out over one unix domain socket per worker. messages are length prefixed and little
+// endian, so the socket can be swapped for tcp later without touching either side's logic
+// a shard whose worker dies, sends garbage or goes quiet for BATCH_SHARD_TIMEOUT_MS goes back on the queue for a
+// fresh worker, up to BATCH_MAX_ATTEMPTS (quiet means no complete message - a header on its own doesn't count)
+
+#define BATCH_MAX_ATTEMPTS 3
+#define BATCH_SHARD_TIMEOUT_MS 30000 // a single polyline never takes anywhere near this
+#define BATCH_SHARDS_PER_WORKER 4 // more, smaller shards balance better and lose less on a retry
+#define BATCH_MIN_SHARD_BYTES 4096
+
+typedef struct {
+    int num_workers;
+    int num_terms;
+    FourierOptions opts; // workers are forked, so this gets to them for free (would need sending over tcp)
+    int progress; // progress and retries on stderr
+} BatchOptions;
+
+// returns number of polylines written, -1 if the input can't be read, a shard fails every attempt or a write fails
+long batch_run(const char *input, FILE *out, const BatchOptions *bo);
+
+#endif
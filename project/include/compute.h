@@ -0,0 +1,51 @@
+#ifndef COMPUTE_H
+#define COMPUTE_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include "geometry.h"
+#include "fourier.h"
+
+// copy of a finished stroke plus the settings to transform it with
+typedef struct {
+    Polyline line;
+    int dimension;
+    int num_terms;
+    FourierOptions opts;
+    int seq; // numbered by compute_publish, so compute_idle can tell when the newest one is done
+} StrokeSnapshot;
+
+// runs the fourier side on its own thread so the event loop never waits on it
+// event loop -> thread: single slot mailbox, newest snapshot replaces any unread one (lock free pointer swap)
+// thread -> event loop: two canvases, thread draws into the back one and flips once the front has been taken
+typedef struct {
+    SDL_Thread *thread;
+    SDL_sem *wake;
+    SDL_atomic_t running;
+    void *mailbox; // StrokeSnapshot *, only touched through SDL_AtomicSetPtr / SDL_AtomicGetPtr
+    uint8_t *canvases[2]; // each RASTER_SIZE * RASTER_SIZE
+    SDL_atomic_t front; // index of the canvas the event loop may read
+    SDL_atomic_t fresh; // 1 while front holds a canvas the event loop hasn't taken yet
+    int morph_frames; // 2D strokes tween from the previous shape over this many canvases (0 = off)
+    SDL_atomic_t published; // strokes handed over so far
+    SDL_atomic_t finished; // seq of the last stroke whose final canvas has been put on front
+} ComputeThread;
+
+// allocates canvases and starts the thread, returns 0 on failure
+int compute_start(ComputeThread *ct, int morph_frames);
+
+// stops the thread and frees everything (safe to call after a failed start)
+void compute_stop(ComputeThread *ct);
+
+// copies pl (and opts, NULL for defaults) and hands it to the thread, returns 0 on malloc failure
+int compute_publish(ComputeThread *ct, const Polyline *pl, int dimension, int num_terms, const FourierOptions *opts);
+
+// returns 1 once every published stroke has its final canvas on front (it may not have been acquired yet)
+int compute_idle(ComputeThread *ct);
+
+// returns the newest finished canvas, or NULL if nothing new since the last release
+// canvas stays valid until compute_release is called
+const uint8_t *compute_acquire(ComputeThread *ct);
+void compute_release(ComputeThread *ct);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef DESCRIPTORS_H
+#define DESCRIPTORS_H
+
+#include "fourier.h"
+
+// edits done straight on the 2K+1 descriptor array (centroid at [K]) - O(K), no resampling or transform
+// z(t) = sum c_k e^{2 pi i k t}, so:
+//   moving the shape only touches c_0
+//   scaling / rotating about the centroid multiplies every other c_k by one complex number
+//   starting the trace later multiplies c_k by e^{2 pi i k tau}
+//   blending two shapes blends their coefficients
+
+void descriptors_translate(complex_t *d, int K, double dx, double dy);
+
+// angle in radians, positive turns x towards y (clockwise on screen since y points down)
+void descriptors_scale_rotate(complex_t *d, int K, double scale, double angle);
+
+// moves the start of the trace forward by tau of a loop (0 to 1)
+void descriptors_shift_start(complex_t *d, int K, double tau);
+
+// out = (1 - t) a + t b, missing harmonics count as zero, so Ka and Kb can differ
+// out must hold 2 * K_out + 1 entries, K_out = max(Ka, Kb)
+void descriptors_blend(const complex_t *a, int Ka, const complex_t *b, int Kb, double t, complex_t *out);
+
+// shifts d's start point to whichever of num_candidates evenly spaced starts lines up best with ref
+// stops a morph between similar shapes spinning round because the strokes began in different places
+// returns the tau applied
+double descriptors_align_start(const complex_t *ref, int K_ref, complex_t *d, int K, int num_candidates);
+
+#endif
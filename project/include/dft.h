@@ -0,0 +1,37 @@
+#ifndef DFT_H
+#define DFT_H
+
+#include <stdlib.h>
+#include "fourier.h"
+
+// alternative kernels for the two sums in fourier.c, same inputs and outputs as
+// dft_real_coeffs (1D) and compute_fourier_descriptors (2D) so planner.c can swap them freely
+
+typedef enum {
+    DFT_DIRECT = 0, // the original loops - best for tiny K
+    DFT_GOERTZEL, // second order recurrence per harmonic, one cos per k instead of per sample
+    DFT_FFT, // radix 2, all N bins at once - power of two N only
+    DFT_NUM_ALGOS
+} DftAlgo;
+
+// the original kernels in fourier.c
+void dft_real_coeffs(const float *f, size_t N, int K, double *a0_out, double *a, double *b);
+void compute_fourier_descriptors(const Pt *input, size_t num_pts, int K, complex_t *output);
+
+int is_power_of_two(size_t n);
+
+// nearest size with a generated kernel (see tools/gen_codelets.c), clamped to that range
+size_t fft_specialized_size(size_t n);
+
+// in place forward transform (e^{-i...}), N must be a power of two
+// sizes listed in the makefile's CODELET_SIZES go to their generated kernel, others to the generic loop
+void fft_complex(double *re, double *im, size_t N);
+
+void dft_real_coeffs_goertzel(const float *f, size_t N, int K, double *a0_out, double *a, double *b);
+void compute_fourier_descriptors_goertzel(const Pt *input, size_t num_pts, int K, complex_t *output);
+
+// return 0 if N isn't a power of two or on malloc failure (outputs untouched)
+int dft_real_coeffs_fft(const float *f, size_t N, int K, double *a0_out, double *a, double *b);
+int compute_fourier_descriptors_fft(const Pt *input, size_t num_pts, int K, complex_t *output);
+
+#endif
@@ -9,10 +9,13 @@
 
 // think about this - careful with types
 typedef struct {
-    Polyline line;
+    PointStore store; // points as they arrive - kept between strokes so drawing doesn't allocate
+    Polyline line; // contiguous copy of store, only brought up to date by draw_input_polyline
     int is_drawing;
     float min_dist;
     size_t max_pts;
+    unsigned int version; // bumped whenever the line changes, so callers know when to recompute
+    unsigned int strokes; // bumped by draw_input_clear only, so views know to redraw from scratch
 } DrawInput;
 
 
@@ -21,6 +24,10 @@ void draw_input_free(DrawInput *di);
 void draw_input_clear(DrawInput *di); // think about this - difference between pl and di
 
 void draw_input_handling(DrawInput *di, const SDL_Event *e);
+
+// contiguous view of the current stroke (copies only points added since the last call)
+// returns NULL on malloc failure
+const Polyline *draw_input_polyline(DrawInput *di);
 // clarify SDL_event syntax
 
 
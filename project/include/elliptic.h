@@ -0,0 +1,14 @@
+#ifndef ELLIPTIC_H
+#define ELLIPTIC_H
+
+#include "fourier.h"
+#include "geometry.h"
+
+// elliptic fourier descriptors (Kuhl & Giardina 1982) for the closed polygon through pl
+// integrates each raw segment exactly, so no resampling and no aliasing - O(segments * K)
+// results land in the same 2K+1 complex layout as compute_fourier_descriptors (centroid at output[K])
+// so the rest of the 2D pipeline can't tell the engines apart
+// returns 0 if pl is degenerate (fewer than 2 pts or zero length) or on malloc failure
+int elliptic_descriptors(const Polyline *pl, int K, complex_t *output);
+
+#endif
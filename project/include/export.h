@@ -0,0 +1,37 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "fourier.h"
+
+#define EXPORT_TRACE_FRAMES 120 // default length of a pen trace
+#define EXPORT_FPS 30
+#define EXPORT_WRITE_BUFFER (8 << 20) // stdio buffer for the output, frames are ~400KB each
+
+typedef enum {
+    EXPORT_PROGRESSIVE = 0, // frame f shows the first f+1 harmonics over the original outline
+    EXPORT_TRACE // epicycles drawing the full approximation as t goes round once
+} ExportMode;
+
+typedef enum {
+    EXPORT_Y4M = 0, // 4:2:0 yuv4mpeg (ffmpeg, mpv etc read it directly)
+    EXPORT_PGM // back to back binary pgm frames, greyscale
+} ExportFormat;
+
+typedef struct {
+    ExportMode mode;
+    ExportFormat format;
+    int num_frames; // trace only - progressive always has one frame per harmonic
+    int num_threads; // render threads, 0 for one per core
+} ExportOptions;
+
+void export_options_default(ExportOptions *eo);
+
+// picks the format from the file name (.y4m, anything else is pgm)
+ExportFormat export_format_from_name(const char *filename);
+
+// renders every frame across worker threads and writes them to filename in order
+// descriptors are 2K+1 entries, centroid at [K] - outline (can be NULL) is drawn as the original shape
+// returns number of frames written, -1 if the file can't be written or on malloc/thread failure
+long export_animation(const char *filename, const complex_t *descriptors, int K, const Pt *outline, size_t num_outline, const ExportOptions *eo);
+
+#endif
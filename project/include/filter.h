@@ -0,0 +1,22 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "fourier.h"
+
+// "Smooth" step from the plan - tapers the coefficients once, before reconstruction
+// hard truncation at K rings around corners (gibbs), a window that falls off towards K doesn't
+// the types live in fourier.h since FourierOptions carries one
+
+// weight (normally 0 to 1) applied to harmonic k of K, k >= 1
+double filter_weight(const FourierFilter *filter, int k, int K);
+
+// scales the K cosine / sine coefficients from dft_real_coeffs in place (mean term is left alone)
+void filter_coeffs_1d(const FourierFilter *filter, int K, double *a, double *b);
+
+// scales the 2K+1 descriptors in place, +k and -k get the same weight, centroid is left alone
+void filter_descriptors_2d(const FourierFilter *filter, int K, complex_t *descriptors);
+
+// parses "none", "gaussian", "lanczos" or "fejer", returns 0 for anything else
+int filter_from_name(const char *name, FourierFilter *out);
+
+#endif
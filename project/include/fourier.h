@@ -6,6 +6,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>
+#include <time.h>
 
 // careful with M_PI
 
@@ -16,8 +17,85 @@ typedef struct {
     double y;
 } Pt;
 
-int fourier_1d(uint8_t *canvas, size_t width, size_t height, int num_terms);
+typedef struct { double re, im; } complex_t;
 
-int fourier_2d_from_pl(uint8_t *canvas, size_t width, size_t height, int num_terms, const Polyline *pl);
+// how the 2D descriptors get computed
+typedef enum {
+    FOURIER_ENGINE_DFT = 0, // resample uniformly then discrete transform (Zahn-Roskies style)
+    FOURIER_ENGINE_ELLIPTIC // Kuhl-Giardina, integrates the raw polyline segments exactly
+} FourierEngine;
+
+// window applied to the coefficients before reconstruction (see filter.h)
+typedef enum {
+    FILTER_NONE = 0, // plain truncation at K
+    FILTER_GAUSSIAN, // exp(-strength * (k / (K+1))^2)
+    FILTER_LANCZOS, // sigma factors, sinc(k / (K+1))
+    FILTER_FEJER, // 1 - k / (K+1)
+    FILTER_CUSTOM // kernel(k, K, data)
+} FilterKind;
+
+#define FILTER_GAUSSIAN_STRENGTH 2.0
+
+typedef double (*FilterKernel)(int k, int K, void *data);
+
+typedef struct {
+    FilterKind kind;
+    double strength; // gaussian only
+    FilterKernel kernel; // custom only
+    void *data;
+} FourierFilter;
+
+// settings shared by the transforms - pass NULL anywhere for the defaults
+typedef struct {
+    FourierEngine engine;
+    FourierFilter filter;
+    int snap_samples; // dft engine rounds its resample count to a size with a generated fft kernel
+} FourierOptions;
+
+void fourier_options_default(FourierOptions *opts);
+
+// state for drawing the 2D approximation a few harmonics at a time
+// descriptors are computed once up front, then each step adds more harmonics onto partial
+typedef struct {
+    Pt *spaced_pts; // uniformly resampled input (raw vertices for the elliptic engine) - drawn as the original
+    size_t num_pts;
+    complex_t *descriptors; // 2K+1 entries, centroid in the middle
+    int K;
+    int k_done; // harmonics already summed into partial
+    Pt *partial; // running reconstruction
+    size_t num_samples;
+} Fourier2DProgress;
+
+int fourier_1d(uint8_t *canvas, size_t width, size_t height, int num_terms, const FourierOptions *opts);
+
+int fourier_2d_from_pl(uint8_t *canvas, size_t width, size_t height, int num_terms, const Polyline *pl, const FourierOptions *opts);
+
+// sums the first K harmonics at num_samples evenly spaced points around the loop
+// descriptors are 2K+1 entries, centroid at [K] - so descriptors + (K - k) is a valid k harmonic series
+void reconstruct_series_2d(const complex_t *input, int K, size_t num_samples, Pt *output);
+
+// samples needed so chords stay within a quarter pixel of the curve, clamped to max_samples
+size_t adaptive_num_samples(const complex_t *input, int K, size_t max_samples);
+
+// times the planner for every size this dimension can ask for with num_terms harmonics
+// call once at startup, after loading any wisdom - buckets it already covers aren't timed again
+void fourier_prepare_plans(int dimension, int num_terms, const FourierOptions *opts);
+
+// reconstructs already computed descriptors (2K+1, centroid at [K]) onto canvas
+// outline (can be NULL) is drawn underneath as the original shape
+int fourier_2d_from_descriptors(uint8_t *canvas, const complex_t *descriptors, int K, const Pt *outline, size_t num_outline);
+
+void fourier_2d_progress_init(Fourier2DProgress *fp);
+void fourier_2d_progress_free(Fourier2DProgress *fp);
+
+// resamples pl (dft engine only) and computes descriptors, returns 0 on bad input or malloc failure
+int fourier_2d_progress_start(Fourier2DProgress *fp, int num_terms, const Polyline *pl, const FourierOptions *opts);
+
+// adds harmonic bands until budget_ms is used up (always at least one), then redraws canvas
+// canvas must be RASTER_SIZE * RASTER_SIZE
+int fourier_2d_progress_step(Fourier2DProgress *fp, uint8_t *canvas, double budget_ms);
+
+// returns 1 once every harmonic has been added
+int fourier_2d_progress_done(const Fourier2DProgress *fp);
 
 #endif
\ No newline at end of file
@@ -16,6 +16,24 @@ typedef struct {
     size_t cap;
 } Polyline;
 
+// points stored in fixed size blocks so a growing stroke never gets copied
+// blocks go back to a free list on clear and are reused by the next stroke
+#define POINT_CHUNK_SHIFT 12
+#define POINT_CHUNK_SIZE (1 << POINT_CHUNK_SHIFT) // 4096 pts (32KB) per chunk
+
+typedef struct PointChunk {
+    struct PointChunk *next; // only used while on the free list
+    Vec2 pts[POINT_CHUNK_SIZE];
+} PointChunk;
+
+typedef struct {
+    PointChunk **chunks; // chunks in order, only pointers get copied if this grows
+    size_t num_chunks;
+    size_t chunk_cap;
+    PointChunk *free_list; // retired chunks waiting for the next stroke
+    size_t len;
+} PointStore;
+
 float vec2_dist(Vec2 a, Vec2 b);
 Vec2 vec2_add(Vec2 a, Vec2 b);
 Vec2 vec2_sub(Vec2 a, Vec2 b);
@@ -40,6 +58,26 @@ void polyline_clear(Polyline *pl);
 // returns 1 if polyline has no pts, otherwise 0 if non-empty
 int polyline_empty(Polyline *pl);
 
+void point_store_init(PointStore *ps);
+
+// releases all chunks, including the free list
+void point_store_free(PointStore *ps);
+
+// empties the store but keeps its chunks for reuse (no free calls)
+void point_store_clear(PointStore *ps);
+
+// appends a point, O(1) with no copying
+// returns 0 if a new chunk is needed and malloc fails
+int point_store_push(PointStore *ps, Vec2 p);
+
+// ith point, i must be < len
+Vec2 point_store_get(const PointStore *ps, size_t i);
+
+// brings pl up to date with ps as one contiguous array, copying only points pl doesn't have yet
+// assumes pl has only ever been filled from ps (clear both together)
+// returns 0 on malloc failure
+int point_store_view(const PointStore *ps, Polyline *pl);
+
 #endif
 
 
@@ -0,0 +1,35 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdlib.h>
+#include "dft.h"
+
+// picks the fastest kernel in dft.h for each (N, K)
+// sizes are grouped into power of two buckets, each bucket is timed once (or read from a wisdom file)
+// and the answer is cached - after that a choice is a table lookup
+// planner_prepare times the expected buckets up front, anything outside them is timed on first use
+
+typedef enum {
+    PLAN_1D = 0, // real coefficients (fourier_1d)
+    PLAN_2D = 1 // complex descriptors (fourier_2d_from_pl)
+} PlanKind;
+
+// reads "kind n_bucket k_bucket best best_without_fft" lines saved by planner_save_wisdom
+// returns number of entries loaded, 0 if the file is missing or empty
+int planner_load_wisdom(const char *filename);
+
+// returns 0 if the file can't be written
+int planner_save_wisdom(const char *filename);
+
+// times every bucket covering N_min..N_max with up to K_max harmonics that isn't already known
+// meant for startup, so the first transform doesn't stall on direct dft timings
+void planner_prepare(PlanKind kind, size_t N_min, size_t N_max, int K_max);
+
+// best kernel for this size (never DFT_FFT unless N is a power of two)
+DftAlgo planner_choose(PlanKind kind, size_t N, int K);
+
+// planned versions of dft_real_coeffs / compute_fourier_descriptors
+void planned_real_coeffs(const float *f, size_t N, int K, double *a0_out, double *a, double *b);
+void planned_descriptors(const Pt *input, size_t num_pts, int K, complex_t *output);
+
+#endif
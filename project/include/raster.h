@@ -23,4 +23,9 @@ void raster_closed_polyline(uint8_t *img, const Polyline *pl, uint8_t val);
 
 void raster_closed_line_from_pts(uint8_t *img, const Pt *pts, size_t N, uint8_t v);
 
+// like raster_closed_line_from_pts without the segment back to the start
+void raster_open_line_from_pts(uint8_t *img, const Pt *pts, size_t N, uint8_t v);
+
+void raster_circle(uint8_t *img, double cx, double cy, double radius, uint8_t val);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include "fourier.h"
+
+// 1D approximation for signals far longer than a canvas (eg sensor logs)
+// samples are cut into hann windows overlapping by half, each window is truncated to K harmonics
+// memory stays fixed at a few windows worth no matter how long the input is
+
+typedef enum {
+    STREAM_OUTPUT_RECON = 0, // one reconstructed sample per input sample (overlap-add of the windows)
+    STREAM_OUTPUT_COEFFS // one line per window: index, first sample, a0, a1 b1 ... aK bK
+} StreamOutput;
+
+// everything that only depends on window size and K, built once and reused for every window
+typedef struct {
+    size_t window; // samples per transform (even)
+    size_t hop; // window / 2
+    int K;
+    double *hann; // window
+    double *cos_table; // K * window, cos(2 pi k n / window)
+    double *sin_table;
+} StreamPlan;
+
+// returns 0 for a bad size (window < 4 or odd, K < 1 or K >= window / 2) or on malloc failure
+int stream_plan_init(StreamPlan *sp, size_t window, int K);
+void stream_plan_free(StreamPlan *sp);
+
+// reads whitespace (or comma) separated numbers from in until EOF, writes text to out
+// filter (can be NULL) is applied to each window's coefficients
+// returns number of windows transformed, or -1 on malloc failure / unreadable number
+long stream_1d(FILE *in, FILE *out, const StreamPlan *sp, StreamOutput mode, const FourierFilter *filter);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef STROKE_LAYER_H
+#define STROKE_LAYER_H
+
+#include <SDL2/SDL.h>
+#include "draw_input.h"
+
+#define STROKE_BATCH 1024 // points per SDL_RenderDrawLines call
+
+// the draw window's stroke kept on a render target texture between frames
+// each frame only the segments added since the last one are drawn (one SDL_RenderDrawLines call
+// unless a frame brings in more than STROKE_BATCH points), the texture is only wiped on a new stroke
+typedef struct {
+    SDL_Texture *target; // NULL if the renderer has no render targets - then the whole stroke is redrawn each frame
+    int width;
+    int height;
+    size_t drawn; // points of the store already on the texture
+    unsigned int strokes; // di->strokes when the texture was last wiped
+    int dirty; // texture contents can't be trusted (first frame, lost render targets)
+    SDL_Point batch[STROKE_BATCH];
+} StrokeLayer;
+
+// returns 1 with a render target, 0 if it fell back to full redraws (the layer works either way)
+int stroke_layer_init(StrokeLayer *sl, SDL_Renderer *ren, int width, int height);
+void stroke_layer_free(StrokeLayer *sl);
+
+// call on SDL_RENDER_TARGETS_RESET - the texture is redrawn from the store next frame
+void stroke_layer_invalidate(StrokeLayer *sl);
+
+// brings the texture up to date with di and copies it to the renderer's current target
+void stroke_layer_render(StrokeLayer *sl, SDL_Renderer *ren, const DrawInput *di);
+
+#endif
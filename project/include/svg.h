@@ -0,0 +1,51 @@
+#ifndef SVG_H
+#define SVG_H
+
+#include <stdlib.h>
+#include "fourier.h"
+
+// shapes built from straight and bezier pieces, kept as control points rather than flattened
+typedef enum {
+    SEGMENT_LINE = 1, // p[0] -> p[1]
+    SEGMENT_QUAD = 2, // p[0], p[1] control, p[2]
+    SEGMENT_CUBIC = 3 // p[0], p[1], p[2] controls, p[3]
+} SegmentType;
+
+// the enum value doubles as the polynomial degree
+typedef struct {
+    SegmentType type;
+    Pt p[4];
+} PathSegment;
+
+// one closed loop - separate subpaths get joined by straight pen-up segments
+typedef struct {
+    PathSegment *segs;
+    size_t len;
+    size_t cap;
+} Shape;
+
+void shape_init(Shape *s);
+void shape_free(Shape *s);
+
+// parses svg path data ("d" attribute), supports M/L/H/V/C/Q/Z in absolute and relative form
+// appends to out, returns 0 on syntax errors, unsupported commands or malloc failure
+int svg_parse_path(const char *d, Shape *out);
+
+// reads every d="..." path in an svg file into out (or the whole file if it's bare path data)
+// a path that doesn't parse is skipped with a warning on stderr, the rest still load
+// returns 0 if the file can't be read or nothing parses
+int svg_load_file(const char *filename, Shape *out);
+
+// scales and centres the shape to fit a size x size canvas with margin pixels spare
+void shape_fit(Shape *s, double size, double margin);
+
+// fourier descriptors of the closed shape, 2K+1 entries with centroid at output[K]
+// integrates each segment analytically (time along each piece ~ its length) - nothing gets flattened
+// O(segments * K), returns 0 for empty / zero length shapes
+int shape_descriptors(const Shape *s, int K, complex_t *output);
+
+// flattens into num_per_segment points per segment - only for drawing the original
+// caller frees *pts_out, returns 0 on malloc failure
+int shape_outline(const Shape *s, size_t num_per_segment, Pt **pts_out, size_t *num_out);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+// monotonic clock in ms - only good for measuring intervals (frame budgets, planner timings)
+// never jumps with ntp or the user changing the time, so differences are always >= 0
+double now_ms(void);
+
+#endif
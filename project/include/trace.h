@@ -0,0 +1,55 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdint.h>
+
+// mouse input recorded to disk so the interactive path can be rerun without a human
+// file is an 8 byte header ("FTRC" + little endian version) followed by 10 byte records:
+//   type (u8), button (u8), x (i16), y (i16), time in ms since the first event (u32), all little endian
+
+#define TRACE_VERSION 1
+
+typedef enum {
+    TRACE_MOUSE_DOWN = 1,
+    TRACE_MOUSE_UP = 2,
+    TRACE_MOUSE_MOTION = 3
+} TraceEventType;
+
+typedef struct {
+    uint8_t type; // TraceEventType
+    uint8_t button;
+    int16_t x;
+    int16_t y;
+    uint32_t time_ms;
+} TraceEvent;
+
+typedef struct {
+    FILE *f;
+    Uint32 start_ms; // SDL timestamp of the first recorded event
+    size_t count;
+} TraceRecorder;
+
+typedef struct {
+    TraceEvent *events;
+    size_t len;
+} Trace;
+
+// returns 0 if the file can't be created
+int trace_recorder_open(TraceRecorder *tr, const char *filename);
+
+// appends mouse button / motion events, anything else is ignored
+// returns 0 on write failure
+int trace_record(TraceRecorder *tr, const SDL_Event *e);
+void trace_recorder_close(TraceRecorder *tr);
+
+// reads a whole trace into memory
+// returns 0 on a bad file (including timestamps that go backwards) or malloc failure
+int trace_load(const char *filename, Trace *out);
+void trace_free(Trace *t);
+
+// rebuilds the SDL event draw_input_handling expects (windowID left at 0)
+void trace_to_sdl_event(const TraceEvent *te, SDL_Event *out);
+
+#endif
@@ -1,21 +1,523 @@
 #include <SDL2/SDL.h>
 #include <stdio.h>
+#include <string.h>
 #include "geometry.h"
 #include "draw_input.h"
 #include "raster.h"
+#include "stroke_layer.h"
 #include "fourier.h"
+#include "compute.h"
+#include "svg.h"
+#include "trace.h"
+#include "filter.h"
+#include "stream.h"
+#include "planner.h"
+#include "export.h"
+#include "batch.h"
 
 // #define RASTER_DISPLAY 1
 #define PIXEL_GAP 20
+#define SVG_MARGIN 32 // pixels left around an imported svg
+#define SVG_OUTLINE_STEPS 16 // points per curve when drawing the svg original
+#define MORPH_FRAMES 45 // ~0.75s at 60fps
+#define REPLAY_FRAME_MS 16 // replayed events are grouped into frames this long, like the live loop
+
+// prints command line options
+static void usage(const char *prog){
+    printf("Usage: %s [--engine dft|elliptic] [--filter none|gaussian|lanczos|fejer] [--svg file] [--morph]\n", prog);
+    printf("       [--record file | --replay file [--realtime]]\n");
+    printf("       [--wisdom file] [--snap]\n");
+    printf("       %s --export file.y4m|file.pgm (--svg file | --replay file) [--trace] [--frames N] [--threads N]\n", prog);
+    printf("       %s --stream file|- --terms K [--window N] [--coeffs] [--filter ...]\n", prog);
+    printf("       %s --batch file --terms K [--workers N] [--engine ...] [--filter ...] [--snap]\n", prog);
+    printf("  --engine   how 2D descriptors are computed: resampled dft (default) or elliptic (exact per segment)\n");
+    printf("  --filter   window applied to the coefficients before reconstruction, softens ringing at corners\n");
+    printf("  --svg      shows the 2D approximation of the paths in an svg file before anything is drawn\n");
+    printf("  --morph    in 2D, each new stroke's approximation morphs out of the previous one\n");
+    printf("  --record   saves mouse input in the draw window to a trace file\n");
+    printf("  --replay   runs a trace file through the pipeline without windows and reports per frame latency\n");
+    printf("  --realtime replays at the recorded speed rather than as fast as possible\n");
+    printf("  --stream   approximates a long 1D signal (numbers from a file or stdin) window by window, no windows opened\n");
+    printf("  --terms    harmonics per window for --stream, or per shape for --batch\n");
+    printf("  --window   samples per window for --stream (even, default %d), windows overlap by half\n", RASTER_SIZE);
+    printf("  --coeffs   --stream prints each window's coefficients instead of the reconstructed signal\n");
+    printf("  --wisdom   loads timed transform choices from a file at startup and saves them back at exit\n");
+    printf("  --snap     in 2D (dft engine), resamples strokes to the nearest size with a generated fft kernel\n");
+    printf("  --export   renders an animation of the svg (or the trace's last stroke) to a y4m or pgm file, no windows opened\n");
+    printf("  --trace    --export draws epicycles tracing the shape instead of adding one harmonic per frame\n");
+    printf("  --frames   frames in a --trace export (default %d)\n", EXPORT_TRACE_FRAMES);
+    printf("  --threads  render threads for --export (default one per core)\n");
+    printf("  --batch    2D descriptors for every polyline in a file (one per line, x y pairs) across worker processes, to stdout\n");
+    printf("  --workers  worker processes for --batch (default one per core)\n");
+}
+
+// headless 1D mode for signals much longer than the canvas - output goes to stdout
+static int run_stream(const char *filename, size_t window, int num_terms, int coeffs, const FourierOptions *opts){
+    FILE *in = stdin;
+    if (strcmp(filename, "-") != 0) {
+        in = fopen(filename, "r");
+        if (!in) {
+            fprintf(stderr, "Could not open %s\n", filename);
+            return 1;
+        }
+    }
+
+    StreamPlan plan;
+    if (!stream_plan_init(&plan, window, num_terms)) {
+        fprintf(stderr, "Window must be even and at least 4, and terms from 1 to window / 2 - 1\n");
+        if (in != stdin) fclose(in);
+        return 1;
+    }
+
+    long windows = stream_1d(in, stdout, &plan, coeffs ? STREAM_OUTPUT_COEFFS : STREAM_OUTPUT_RECON, &opts->filter);
+    if (windows < 0) fprintf(stderr, "Stream stopped early: unreadable number or out of memory\n");
+
+    stream_plan_free(&plan);
+    if (in != stdin) fclose(in);
+    return windows < 0;
+}
+
+// headless 2D mode for whole shape libraries - descriptors go to stdout in input order, progress to stderr
+static int run_batch(const char *filename, int num_workers, int num_terms, const FourierOptions *opts){
+    if (num_terms < 1) {
+        fprintf(stderr, "--batch needs --terms K (at least 1)\n");
+        return 1;
+    }
+
+    BatchOptions bo;
+    bo.num_workers = num_workers > 0 ? num_workers : SDL_GetCPUCount();
+    bo.num_terms = num_terms;
+    bo.opts = *opts;
+    bo.progress = 1;
+
+    long shapes = batch_run(filename, stdout, &bo);
+    if (shapes < 0) {
+        fprintf(stderr, "Batch over %s failed\n", filename);
+        return 1;
+    }
+    fprintf(stderr, "%ld polylines from %s\n", shapes, filename);
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b){
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// copies a canvas into the streaming texture (1 = approximation in white, 2 = original in red)
+static void upload_canvas(SDL_Texture *tex, const uint8_t *canvas){
+    void *pixels = NULL; // raw ptr
+    int pitch = 0;
+
+    if (SDL_LockTexture(tex, NULL, &pixels, &pitch)==0){;
+        uint8_t *dest = (uint8_t *)pixels;
+        for (int y = 0; y < RASTER_SIZE; ++y){
+            //uint8_t *row = dest * y + pitch;
+            for (int x = 0; x < RASTER_SIZE; ++x){
+
+                uint8_t v = canvas[y * RASTER_SIZE + x];
+
+                uint8_t r = 0, g = 0, b = 0;
+
+                if (v == 1) { r = g = b = 255; }
+                else if (v == 2) { r = 255; }
+
+                dest[y * pitch + x * 3 + 0] = r;
+                dest[y * pitch + x * 3 + 1] = g;
+                dest[y * pitch + x * 3 + 2] = b;
+            }
+        }
+        SDL_UnlockTexture(tex);
+    }
+}
+
+// everything the event loop does for a frame once input is handled - shared with --replay so it times the same path
+typedef struct {
+    SDL_Renderer *ren_draw;
+    SDL_Renderer *ren_raster;
+    SDL_Texture *tex_raster;
+    StrokeLayer *layer;
+    ComputeThread *compute;
+    int dimension;
+    int num_terms;
+    const FourierOptions *opts;
+    unsigned int shown_version; // last stroke sent to the fourier side
+    int has_output;
+} FrameState;
+
+// draws new stroke segments, hands a finished stroke to the compute thread and shows the newest canvas
+// returns 1 if a stroke was handed over this frame
+static int run_frame(FrameState *fs, DrawInput *di){
+    // new segments only - the full stroke is redrawn just after a clear
+    stroke_layer_render(fs->layer, fs->ren_draw, di);
+    SDL_RenderPresent(fs->ren_draw);
+
+    // only recompute once a stroke is finished and has changed
+    int published = 0;
+    if (!di->is_drawing && di->store.len >= 2 && di->version != fs->shown_version){
+        const Polyline *pl = draw_input_polyline(di); // only materialised once the stroke is done
+        if (pl && compute_publish(fs->compute, pl, fs->dimension, fs->num_terms, fs->opts)){
+            fs->shown_version = di->version;
+            published = 1;
+        }
+    }
+
+    // 2D output arrives a few harmonics at a time, so this can update over several frames
+    const uint8_t *canvas = compute_acquire(fs->compute);
+    if (canvas){
+        upload_canvas(fs->tex_raster, canvas);
+        compute_release(fs->compute);
+        fs->has_output = 1;
+    }
+
+    if (fs->has_output){
+        SDL_SetRenderDrawColor(fs->ren_raster, 0, 0, 0, 255); // background colour - black
+        SDL_RenderClear(fs->ren_raster);
+        SDL_RenderCopy(fs->ren_raster, fs->tex_raster, NULL, NULL);
+        SDL_RenderPresent(fs->ren_raster);
+    }
+    return published;
+}
+
+static void print_latency(const char *label, double *latency, size_t n){
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) sum += latency[i];
+    qsort(latency, n, sizeof(double), compare_double);
+    printf("%s (ms): min %.3f  mean %.3f  p50 %.3f  p95 %.3f  max %.3f\n", label,
+        latency[0], sum / (double)n, latency[n / 2], latency[(n * 95) / 100], latency[n-1]);
+}
+
+// feeds a recorded trace through the live pipeline - draw_input_handling then run_frame, compute thread included -
+// with both windows swapped for offscreen software renderers, so presenting costs nothing window related
+// frame latency is the event loop's own time per frame, stroke latency runs from the frame a stroke is handed over
+// until its final canvas has been uploaded (frames carry on after the last event until that happens)
+static int run_replay(const char *filename, int realtime, int dimension, int num_terms, int morph_frames, const FourierOptions *opts){
+    Trace trace;
+    if (!trace_load(filename, &trace)){
+        fprintf(stderr, "Could not read trace %s\n", filename);
+        return 1;
+    }
+    if (trace.len == 0){
+        printf("Trace %s is empty.\n", filename);
+        trace_free(&trace);
+        return 0;
+    }
+
+    // frames with events take at least one each, the ones after the trace grow this as needed
+    size_t frame_cap = trace.len;
+    double *latency = malloc(sizeof(double) * frame_cap);
+    double *stroke_latency = malloc(sizeof(double) * trace.len); // strokes need an event each too
+
+    SDL_Surface *draw_surface = SDL_CreateRGBSurfaceWithFormat(0, RASTER_SIZE, RASTER_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Surface *raster_surface = SDL_CreateRGBSurfaceWithFormat(0, RASTER_SIZE, RASTER_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer *ren_draw = draw_surface ? SDL_CreateSoftwareRenderer(draw_surface) : NULL;
+    SDL_Renderer *ren_raster = raster_surface ? SDL_CreateSoftwareRenderer(raster_surface) : NULL;
+    SDL_Texture *tex_raster = ren_raster ? SDL_CreateTexture(ren_raster,
+        SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, RASTER_SIZE, RASTER_SIZE) : NULL;
+
+    DrawInput di;
+    draw_input_init(&di);
+    StrokeLayer layer;
+    ComputeThread compute;
+
+    int ok = latency && stroke_latency && ren_draw && tex_raster;
+    if (ok) stroke_layer_init(&layer, ren_draw, RASTER_SIZE, RASTER_SIZE);
+    int compute_running = ok && compute_start(&compute, morph_frames);
+    if (!compute_running) fprintf(stderr, "Could not set up offscreen replay: %s\n", SDL_GetError());
+
+    FrameState frame = {ren_draw, ren_raster, tex_raster, &layer, &compute, dimension, num_terms, opts, di.version, 0};
+
+    size_t num_frames = 0;
+    size_t num_strokes = 0;
+    int stroke_pending = 0;
+    Uint64 stroke_start = 0;
+    double freq_ms = (double)SDL_GetPerformanceFrequency() / 1000.0;
+    Uint64 run_start = SDL_GetPerformanceCounter();
+
+    size_t next = 0;
+    Uint32 frame_end = 0;
+    while (compute_running && (next < trace.len || stroke_pending)){
+        // frame holds every event up to the next frame boundary
+        if (next < trace.len) frame_end = (trace.events[next].time_ms / REPLAY_FRAME_MS + 1) * REPLAY_FRAME_MS;
+        else frame_end += REPLAY_FRAME_MS;
+
+        if (realtime){
+            double elapsed = (double)(SDL_GetPerformanceCounter() - run_start) / freq_ms;
+            if (elapsed < frame_end) SDL_Delay((Uint32)(frame_end - elapsed));
+        } else if (next == trace.len){
+            SDL_Delay(1); // only waiting on the compute thread now - don't spin against it
+        }
+
+        if (num_frames == frame_cap){
+            double *grown = realloc(latency, sizeof(double) * frame_cap * 2);
+            if (!grown) break;
+            latency = grown;
+            frame_cap *= 2;
+        }
+
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+
+        // read before run_frame picks anything up, so if it's set the canvas taken below is the stroke's last
+        int idle = compute_idle(&compute);
+
+        while (next < trace.len && trace.events[next].time_ms < frame_end){
+            SDL_Event e;
+            trace_to_sdl_event(&trace.events[next++], &e);
+            draw_input_handling(&di, &e);
+        }
+
+        if (run_frame(&frame, &di)){
+            stroke_pending = 1; // a newer stroke replaces one still in flight, like in the live loop
+            stroke_start = frame_start;
+        } else if (stroke_pending && idle){
+            stroke_latency[num_strokes++] = (double)(SDL_GetPerformanceCounter() - stroke_start) / freq_ms;
+            stroke_pending = 0;
+        }
+
+        latency[num_frames++] = (double)(SDL_GetPerformanceCounter() - frame_start) / freq_ms;
+    }
+
+    double total = (double)(SDL_GetPerformanceCounter() - run_start) / freq_ms;
+
+    if (num_frames > 0){
+        printf("Replayed %zu events in %zu frames (%zu strokes) in %.2f ms\n",
+            trace.len, num_frames, num_strokes, total);
+        print_latency("Frame latency", latency, num_frames);
+        if (num_strokes > 0) print_latency("Stroke latency", stroke_latency, num_strokes);
+    }
+
+    if (compute_running) compute_stop(&compute);
+    if (ok) stroke_layer_free(&layer);
+    draw_input_free(&di);
+    if (tex_raster) SDL_DestroyTexture(tex_raster);
+    if (ren_raster) SDL_DestroyRenderer(ren_raster);
+    if (ren_draw) SDL_DestroyRenderer(ren_draw);
+    if (raster_surface) SDL_FreeSurface(raster_surface);
+    if (draw_surface) SDL_FreeSurface(draw_surface);
+    free(stroke_latency);
+    free(latency);
+    trace_free(&trace);
+    return !compute_running;
+}
+
+// loads an svg and integrates its descriptors straight from the bezier pieces (filter applied)
+// outline is the shape flattened for drawing underneath, caller frees both
+// returns 0 if the file can't be parsed
+static int load_svg(const char *filename, int num_terms, const FourierOptions *opts,
+    complex_t **descriptors_out, Pt **outline_out, size_t *num_outline_out){
+    Shape shape;
+    shape_init(&shape);
+    if (!svg_load_file(filename, &shape)){
+        shape_free(&shape);
+        return 0;
+    }
+    shape_fit(&shape, RASTER_SIZE, SVG_MARGIN);
 
-int main(){
+    complex_t *descriptors = calloc(2 * num_terms + 1, sizeof(complex_t));
+    Pt *outline = NULL;
+    size_t num_outline = 0;
+
+    int ok = descriptors
+        && shape_descriptors(&shape, num_terms, descriptors)
+        && shape_outline(&shape, SVG_OUTLINE_STEPS, &outline, &num_outline);
+    shape_free(&shape);
+
+    if (!ok) {
+        free(descriptors);
+        free(outline);
+        return 0;
+    }
+    filter_descriptors_2d(&opts->filter, num_terms, descriptors);
+    *descriptors_out = descriptors;
+    *outline_out = outline;
+    *num_outline_out = num_outline;
+    return 1;
+}
+
+// draws an svg's approximation over its outline
+static int render_svg(const char *filename, int num_terms, const FourierOptions *opts, uint8_t *canvas){
+    complex_t *descriptors = NULL;
+    Pt *outline = NULL;
+    size_t num_outline = 0;
+    if (!load_svg(filename, num_terms, opts, &descriptors, &outline, &num_outline)) return 0;
+
+    int ok = fourier_2d_from_descriptors(canvas, descriptors, num_terms, outline, num_outline);
+
+    free(descriptors);
+    free(outline);
+    return ok;
+}
+
+// renders an animation of the svg, or of the last stroke in a trace, straight to a file - no windows
+static int run_export(const char *filename, const char *svg_file, const char *replay_file,
+    int num_terms, const FourierOptions *opts, const ExportOptions *eo){
+    complex_t *descriptors = NULL;
+    Pt *outline = NULL;
+    size_t num_outline = 0;
+    int K = num_terms;
+
+    if (svg_file) {
+        if (!load_svg(svg_file, num_terms, opts, &descriptors, &outline, &num_outline)) {
+            fprintf(stderr, "Could not read svg paths from %s\n", svg_file);
+            return 1;
+        }
+    } else {
+        Trace trace;
+        if (!trace_load(replay_file, &trace)){
+            fprintf(stderr, "Could not read trace %s\n", replay_file);
+            return 1;
+        }
+        // whatever is on the canvas once the trace ends - each new stroke clears the last
+        DrawInput di;
+        draw_input_init(&di);
+        for (size_t i = 0; i < trace.len; ++i){
+            SDL_Event e;
+            trace_to_sdl_event(&trace.events[i], &e);
+            draw_input_handling(&di, &e);
+        }
+        trace_free(&trace);
+
+        Fourier2DProgress fp;
+        fourier_2d_progress_init(&fp);
+        const Polyline *pl = draw_input_polyline(&di);
+        int ok = pl && fourier_2d_progress_start(&fp, num_terms, pl, opts);
+        draw_input_free(&di);
+        if (!ok) {
+            fprintf(stderr, "No stroke to export in %s\n", replay_file);
+            return 1;
+        }
+        // keep the descriptors and resampled stroke, drop the rest
+        descriptors = fp.descriptors;
+        outline = fp.spaced_pts;
+        num_outline = fp.num_pts;
+        K = fp.K;
+        fp.descriptors = NULL;
+        fp.spaced_pts = NULL;
+        fourier_2d_progress_free(&fp);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    long frames = export_animation(filename, descriptors, K, outline, num_outline, eo);
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    free(descriptors);
+    free(outline);
+    if (frames < 0) {
+        fprintf(stderr, "Export to %s failed\n", filename);
+        return 1;
+    }
+    printf("Wrote %ld frames to %s in %.2f s\n", frames, filename, seconds);
+    return 0;
+}
+
+int main(int argc, char **argv){
+
+    FourierOptions opts;
+    fourier_options_default(&opts);
+    const char *svg_file = NULL;
+    const char *record_file = NULL;
+    const char *replay_file = NULL;
+    int realtime = 0;
+    int morph = 0;
+    const char *stream_file = NULL;
+    size_t stream_window = RASTER_SIZE;
+    int stream_terms = 0;
+    int stream_coeffs = 0;
+    const char *wisdom_file = NULL;
+    const char *batch_file = NULL;
+    int batch_workers = 0;
+    const char *export_file = NULL;
+    ExportOptions export_opts;
+    export_options_default(&export_opts);
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "dft") == 0) {
+                opts.engine = FOURIER_ENGINE_DFT;
+            } else if (strcmp(name, "elliptic") == 0) {
+                opts.engine = FOURIER_ENGINE_ELLIPTIC;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            if (!filter_from_name(argv[++i], &opts.filter)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--svg") == 0 && i + 1 < argc) {
+            svg_file = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_file = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (strcmp(argv[i], "--morph") == 0) {
+            morph = 1;
+        } else if (strcmp(argv[i], "--realtime") == 0) {
+            realtime = 1;
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            stream_file = argv[++i];
+        } else if (strcmp(argv[i], "--terms") == 0 && i + 1 < argc) {
+            stream_terms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            stream_window = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--coeffs") == 0) {
+            stream_coeffs = 1;
+        } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            export_file = argv[++i];
+            export_opts.format = export_format_from_name(export_file);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            export_opts.mode = EXPORT_TRACE;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            export_opts.num_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            export_opts.num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_file = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            batch_workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--snap") == 0) {
+            opts.snap_samples = 1;
+        } else if (strcmp(argv[i], "--wisdom") == 0 && i + 1 < argc) {
+            wisdom_file = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // planner times each size once, a wisdom file carries those timings across runs
+    if (wisdom_file) planner_load_wisdom(wisdom_file);
+
+    if (export_file && !svg_file && !replay_file) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // stdin may be the signal itself, so no prompts here
+    if (stream_file) {
+        return run_stream(stream_file, stream_window, stream_terms, stream_coeffs, &opts);
+    }
+    if (batch_file) {
+        int status = run_batch(batch_file, batch_workers, stream_terms, &opts);
+        if (wisdom_file && !planner_save_wisdom(wisdom_file)) fprintf(stderr, "Could not write %s\n", wisdom_file);
+        return status;
+    }
 
     printf("\nWelcome to my foray into Fourier Transforms!\n");
     printf("To exit, press Ctrl+C on the command line, or close the graphical interface.\n\n");
 
-    printf("First, would you like calculations in 1D or 2D? (1/2)\n");
-    int dimension;
-    while (1) {
+    int dimension = 2;
+    if (svg_file) {
+        printf("Loading %s, so calculations will be in 2D.\n", svg_file);
+    } else if (export_file) {
+        printf("Exporting to %s, so calculations will be in 2D.\n", export_file);
+    } else {
+        printf("First, would you like calculations in 1D or 2D? (1/2)\n");
+    }
+    while (!svg_file && !export_file) {
         if (scanf("%d", &dimension) != 1) {
             printf("Invalid input. Please type 1 or 2.\n");
             while (getchar() != '\n'); // clears input buffer
@@ -44,6 +546,20 @@ int main(){
     }
 
 
+    // anything the wisdom file didn't cover is timed now rather than in the middle of the first stroke
+    fourier_prepare_plans(dimension, num_terms, &opts);
+
+    // no windows needed - answers to the prompts above can be piped in too
+    if (export_file) {
+        int status = run_export(export_file, svg_file, replay_file, num_terms, &opts, &export_opts);
+        if (wisdom_file && !planner_save_wisdom(wisdom_file)) fprintf(stderr, "Could not write %s\n", wisdom_file);
+        return status;
+    }
+    if (replay_file) {
+        int status = run_replay(replay_file, realtime, dimension, num_terms, morph ? MORPH_FRAMES : 0, &opts);
+        if (wisdom_file && !planner_save_wisdom(wisdom_file)) fprintf(stderr, "Could not write %s\n", wisdom_file);
+        return status;
+    }
 
     // SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl"); // best for my machine (Intel Mac)
 
@@ -51,7 +567,7 @@ int main(){
     SDL_Init(SDL_INIT_VIDEO);
     SDL_Window* win_draw = SDL_CreateWindow("Draw Input",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, RASTER_SIZE, RASTER_SIZE, 0);
-    SDL_Renderer* ren_draw = SDL_CreateRenderer(win_draw, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_Renderer* ren_draw = SDL_CreateRenderer(win_draw, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
 
     char label[64]; // large enough
     snprintf(label, sizeof(label), "Fourier Output (%dD): %d terms", dimension, num_terms);
@@ -85,9 +601,40 @@ int main(){
     DrawInput di;
     draw_input_init(&di);
 
-    static uint8_t canvas[RASTER_SIZE * RASTER_SIZE];
+    // stroke stays on a texture between frames, so each frame only draws what's new
+    StrokeLayer layer;
+    stroke_layer_init(&layer, ren_draw, RASTER_SIZE, RASTER_SIZE);
+
+    // transforms run on their own thread - this loop only hands over strokes and picks up canvases
+    // on failure the loop below is skipped, so everything still goes through the cleanup at the end
+    int status = 0;
+    ComputeThread compute;
+    int compute_running = compute_start(&compute, morph ? MORPH_FRAMES : 0);
+    if (!compute_running){
+        fprintf(stderr, "Could not start compute thread: %s\n", SDL_GetError());
+        status = 1;
+    }
 
-    int active = 1;
+    FrameState frame = {ren_draw, ren_raster, tex_raster, &layer, &compute, dimension, num_terms, &opts, di.version, 0};
+
+    if (svg_file) {
+        static uint8_t svg_canvas[RASTER_SIZE * RASTER_SIZE];
+        if (render_svg(svg_file, num_terms, &opts, svg_canvas)) {
+            upload_canvas(tex_raster, svg_canvas);
+            frame.has_output = 1;
+        } else {
+            fprintf(stderr, "Could not read svg paths from %s\n", svg_file);
+        }
+    }
+
+    TraceRecorder recorder;
+    int recording = 0;
+    if (record_file && compute_running) {
+        recording = trace_recorder_open(&recorder, record_file);
+        if (!recording) fprintf(stderr, "Could not open %s for recording\n", record_file);
+    }
+
+    int active = compute_running;
 
     while (active) {
         SDL_Event e;
@@ -101,15 +648,24 @@ int main(){
                         active = 0;
                     }
                     break;
+                case SDL_RENDER_TARGETS_RESET: // texture contents are gone, redraw from the store
+                    stroke_layer_invalidate(&layer);
+                    break;
+                case SDL_RENDER_DEVICE_RESET: // texture itself is gone
+                    stroke_layer_free(&layer);
+                    stroke_layer_init(&layer, ren_draw, RASTER_SIZE, RASTER_SIZE);
+                    break;
                 case SDL_MOUSEBUTTONUP:
                 case SDL_MOUSEBUTTONDOWN:
                     if (e.button.windowID == id_draw){
+                        if (recording) trace_record(&recorder, &e);
                         draw_input_handling(&di, &e);
                     }
                     break;
 
                 case SDL_MOUSEMOTION:
                     if (e.motion.windowID == id_draw){
+                        if (recording) trace_record(&recorder, &e);
                         draw_input_handling(&di, &e);
                     }
                     break;
@@ -121,70 +677,17 @@ int main(){
 
         if (!active) break;
 
-        SDL_SetRenderDrawColor(ren_draw, 128, 128, 128, 255); // background colour - light gray
-        SDL_RenderClear(ren_draw);
-
-        SDL_SetRenderDrawColor(ren_draw, 0, 0, 0, 255); // line colour - black
-        const Polyline *pl = &di.line;
-
-        size_t n = pl->len;
-        if (n >= 2 && pl->pts) { // should always be true
-            for (size_t i = 1; i < n; ++i) { // check loop conditions here
-                SDL_RenderDrawLine(ren_draw,
-                    (int)pl->pts[i-1].x, (int)pl->pts[i-1].y,
-                    (int)pl->pts[i].x, (int)pl->pts[i].y);
-            }
-
-        }
-        SDL_RenderPresent(ren_draw);
-
-        if (!di.is_drawing && pl->pts && pl->len >= 2){
-
-            raster_clear(canvas);
-            raster_polyline(canvas, &di.line, 255); // white line colour
-
-            if (dimension == 1) {
-                fourier_1d(canvas, RASTER_SIZE, RASTER_SIZE, num_terms);
-            } else if (dimension == 2){
-                fourier_2d_from_pl(canvas, RASTER_SIZE, RASTER_SIZE, num_terms, pl);
-            }
-
-            void *pixels = NULL; // raw ptr
-            int pitch = 0;
-
-            if (SDL_LockTexture(tex_raster, NULL, &pixels, &pitch)==0){;
-                uint8_t *dest = (uint8_t *)pixels;
-                for (int y = 0; y < RASTER_SIZE; ++y){
-                    //uint8_t *row = dest * y + pitch;
-                    for (int x = 0; x < RASTER_SIZE; ++x){
-
-                        uint8_t v = canvas[y * RASTER_SIZE + x];
-
-                        uint8_t r = 0, g = 0, b = 0;
-
-                        if (v == 1) { r = g = b = 255; }
-                        else if (v == 2) { r = 255; }
-
-                        dest[y * pitch + x * 3 + 0] = r;
-                        dest[y * pitch + x * 3 + 1] = g;
-                        dest[y * pitch + x * 3 + 2] = b;
-                    }
-                }
-                SDL_UnlockTexture(tex_raster);
-            }
-
-
-            SDL_SetRenderDrawColor(ren_raster, 0, 0, 0, 255); // background colour - black
-            SDL_RenderClear(ren_raster);
-            SDL_RenderCopy(ren_raster, tex_raster, NULL, NULL);
-            SDL_RenderPresent(ren_raster);
-        }
+        run_frame(&frame, &di);
         SDL_Delay(16); // precaution at 60fps (definitely sufficient)
         
 
     }
 
+    if (recording) trace_recorder_close(&recorder);
+    if (compute_running) compute_stop(&compute);
+    stroke_layer_free(&layer);
     draw_input_free(&di);
+    if (wisdom_file && !planner_save_wisdom(wisdom_file)) fprintf(stderr, "Could not write %s\n", wisdom_file);
 
     SDL_DestroyTexture(tex_raster);
     SDL_DestroyRenderer(ren_raster);
@@ -193,5 +696,5 @@ int main(){
     SDL_DestroyRenderer(ren_draw);
     SDL_DestroyWindow(win_draw);
     SDL_Quit();
-    return 0;
+    return status;
 }
@@ -0,0 +1,582 @@
+#define _POSIX_C_SOURCE 200809L // fork, socketpair, poll, getline, fseeko
+
+#include "batch.h"
+#include "timing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+// messages are an 8 byte header (type, payload length - u32 each) then the payload, all little endian
+//   SHARD  coordinator -> worker  u32 shard, u64 begin, u64 end
+//   QUIT   coordinator -> worker  (empty)
+//   RESULT worker -> coordinator  u32 shard, u32 K, then 2K+1 (re, im) f64 pairs - one per polyline, in file order
+//   DONE   worker -> coordinator  u32 shard, u64 number of RESULTs sent for it
+enum {
+    MSG_SHARD = 1,
+    MSG_QUIT,
+    MSG_RESULT,
+    MSG_DONE
+};
+
+#define MSG_HEADER 8
+#define MSG_MAX_PAYLOAD (1u << 24) // anything bigger is garbage
+
+typedef struct {
+    uint8_t *data;
+    size_t cap;
+} MsgBuf;
+
+// --- encoding ---
+
+static void put_u32(uint8_t *p, uint32_t v){
+    for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t *p, uint64_t v){
+    for (int i = 0; i < 8; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_f64(uint8_t *p, double v){
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u64(p, bits);
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t *p){
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static double get_f64(const uint8_t *p){
+    uint64_t bits = get_u64(p);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// --- socket io ---
+
+static int write_all(int fd, const uint8_t *buf, size_t len){
+    while (len > 0){
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// returns 0 on eof or error
+static int read_all(int fd, uint8_t *buf, size_t len){
+    while (len > 0){
+        ssize_t n = read(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int msg_reserve(MsgBuf *mb, size_t len){
+    if (len <= mb->cap) return 1;
+    uint8_t *data = realloc(mb->data, len);
+    if (!data) return 0;
+    mb->data = data;
+    mb->cap = len;
+    return 1;
+}
+
+// payload has to start at mb->data + MSG_HEADER, the header is filled in here
+static int send_msg(int fd, MsgBuf *mb, uint32_t type, uint32_t len){
+    put_u32(mb->data, type);
+    put_u32(mb->data + 4, len);
+    return write_all(fd, mb->data, MSG_HEADER + len);
+}
+
+// worker side only, the coordinator never blocks on one worker (see read_worker)
+// payload ends up at mb->data, returns 0 on eof, error or an oversized message
+static int recv_msg(int fd, MsgBuf *mb, uint32_t *type, uint32_t *len){
+    uint8_t header[MSG_HEADER];
+    if (!read_all(fd, header, MSG_HEADER)) return 0;
+    *type = get_u32(header);
+    *len = get_u32(header + 4);
+    if (*len > MSG_MAX_PAYLOAD || !msg_reserve(mb, *len > 0 ? *len : 1)) return 0;
+    return read_all(fd, mb->data, *len);
+}
+
+// --- worker ---
+
+// returns 1 if the line holds a polyline (pl may still come back with < 2 points if it's junk), 0 for blank/comments
+static int parse_polyline(const char *line, Polyline *pl){
+    polyline_clear(pl);
+    while (*line == ' ' || *line == '\t') line++;
+    if (*line == '\0' || *line == '\n' || *line == '\r' || *line == '#') return 0;
+
+    double coord[2];
+    int have = 0;
+    while (1){
+        while (*line == ' ' || *line == '\t' || *line == ',' || *line == '\r') line++;
+        if (*line == '\0' || *line == '\n') break;
+        char *end;
+        coord[have] = strtod(line, &end);
+        if (end == line){ // junk - the whole line is unusable
+            polyline_clear(pl);
+            return 1;
+        }
+        line = end;
+        if (++have == 2){
+            Vec2 p = {(float)coord[0], (float)coord[1]};
+            if (!polyline_push(pl, p)){
+                polyline_clear(pl);
+                return 1;
+            }
+            have = 0;
+        }
+    }
+    return 1;
+}
+
+static int send_result(int fd, MsgBuf *mb, uint32_t shard, const Polyline *pl, const BatchOptions *bo){
+    Fourier2DProgress fp;
+    fourier_2d_progress_init(&fp);
+    int K = 0;
+    if (pl->len >= 2 && fourier_2d_progress_start(&fp, bo->num_terms, pl, &bo->opts)) K = fp.K;
+
+    uint32_t len = 8 + (uint32_t)(2 * K + 1) * 16;
+    if (K == 0) len = 8;
+    if (!msg_reserve(mb, MSG_HEADER + len)){
+        fourier_2d_progress_free(&fp);
+        return 0;
+    }
+    uint8_t *p = mb->data + MSG_HEADER;
+    put_u32(p, shard);
+    put_u32(p + 4, (uint32_t)K);
+    p += 8;
+    for (int k = 0; K > 0 && k <= 2 * K; ++k){
+        put_f64(p, fp.descriptors[k].re);
+        put_f64(p + 8, fp.descriptors[k].im);
+        p += 16;
+    }
+    fourier_2d_progress_free(&fp);
+    return send_msg(fd, mb, MSG_RESULT, len);
+}
+
+// runs every polyline starting in [begin, end) through the 2D pipeline, returns 0 if the coordinator is gone
+static int worker_shard(int fd, FILE *f, MsgBuf *mb, uint32_t shard, uint64_t begin, uint64_t end, const BatchOptions *bo){
+    // a line straddling begin belongs to the previous shard
+    if (begin > 0){
+        if (fseeko(f, (off_t)(begin - 1), SEEK_SET) != 0) return 0;
+        int c = fgetc(f);
+        while (c != EOF && c != '\n') c = fgetc(f);
+    } else if (fseeko(f, 0, SEEK_SET) != 0) {
+        return 0;
+    }
+
+    Polyline pl;
+    polyline_init(&pl);
+    char *line = NULL;
+    size_t line_cap = 0;
+    uint64_t count = 0;
+    int ok = 1;
+
+    while (ok){
+        off_t pos = ftello(f);
+        if (pos < 0 || (uint64_t)pos >= end) break;
+        if (getline(&line, &line_cap, f) < 0) break;
+        if (!parse_polyline(line, &pl)) continue;
+        ok = send_result(fd, mb, shard, &pl, bo);
+        count++;
+    }
+    free(line);
+    polyline_free(&pl);
+    if (!ok) return 0;
+
+    put_u32(mb->data + MSG_HEADER, shard);
+    put_u64(mb->data + MSG_HEADER + 4, count);
+    return send_msg(fd, mb, MSG_DONE, 12);
+}
+
+// shards until QUIT, returns the process exit status
+static int worker_main(int fd, const char *input, const BatchOptions *bo){
+    FILE *f = fopen(input, "rb");
+    MsgBuf mb = {NULL, 0};
+    if (!f || !msg_reserve(&mb, MSG_HEADER + 64)) return 1;
+
+    int status = 1;
+    while (1){
+        uint32_t type, len;
+        if (!recv_msg(fd, &mb, &type, &len)) break;
+        if (type == MSG_QUIT){
+            status = 0;
+            break;
+        }
+        if (type != MSG_SHARD || len != 20) break;
+        uint32_t shard = get_u32(mb.data);
+        uint64_t begin = get_u64(mb.data + 4);
+        uint64_t end = get_u64(mb.data + 12);
+        if (!msg_reserve(&mb, MSG_HEADER + 64) || !worker_shard(fd, f, &mb, shard, begin, end, bo)) break;
+    }
+    free(mb.data);
+    fclose(f);
+    return status;
+}
+
+// --- coordinator ---
+
+typedef enum {
+    SHARD_QUEUED = 0,
+    SHARD_RUNNING,
+    SHARD_DONE
+} ShardState;
+
+typedef struct {
+    uint64_t begin;
+    uint64_t end;
+    ShardState state;
+    int attempts;
+    char *text; // "K re im ..." lines, held until every earlier shard has been written
+    size_t len;
+    size_t cap;
+    uint64_t count;
+} Shard;
+
+typedef struct {
+    pid_t pid;
+    int fd; // -1 if this slot has no process
+    int shard; // -1 when idle
+    double deadline; // now_ms() by which the next complete message has to arrive
+    MsgBuf in; // bytes read so far, messages can arrive split across reads
+    size_t have;
+} Worker;
+
+typedef struct {
+    const char *input;
+    FILE *out;
+    const BatchOptions *bo;
+    Shard *shards;
+    int num_shards;
+    Worker *workers;
+    int num_workers;
+    int next_write; // first shard not yet written out
+    int num_done;
+    long written; // polylines written, also the next output index
+    MsgBuf mb;
+} Batch;
+
+static int text_append(Shard *s, const char *str, size_t n){
+    if (s->len + n > s->cap){
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        while (cap < s->len + n) cap *= 2;
+        char *text = realloc(s->text, cap);
+        if (!text) return 0;
+        s->text = text;
+        s->cap = cap;
+    }
+    memcpy(s->text + s->len, str, n);
+    s->len += n;
+    return 1;
+}
+
+static int spawn_worker(Batch *b, int w){
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) return 0;
+
+    // anything buffered would otherwise be written again by the child
+    fflush(b->out);
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0){
+        close(sv[0]);
+        close(sv[1]);
+        return 0;
+    }
+    if (pid == 0){
+        close(sv[0]);
+        for (int i = 0; i < b->num_workers; ++i){
+            if (b->workers[i].fd >= 0) close(b->workers[i].fd);
+        }
+        _exit(worker_main(sv[1], b->input, b->bo)); // _exit so the parent's stdio buffers aren't flushed twice
+    }
+
+    close(sv[1]);
+    b->workers[w].pid = pid;
+    b->workers[w].fd = sv[0];
+    b->workers[w].shard = -1;
+    b->workers[w].have = 0;
+    return 1;
+}
+
+static void reap_worker(Worker *w, int force){
+    if (w->fd < 0) return;
+    if (force) kill(w->pid, SIGKILL);
+    close(w->fd);
+    waitpid(w->pid, NULL, 0);
+    w->fd = -1;
+    w->shard = -1;
+}
+
+static int next_queued(const Batch *b){
+    for (int i = 0; i < b->num_shards; ++i){
+        if (b->shards[i].state == SHARD_QUEUED) return i;
+    }
+    return -1;
+}
+
+// a worker died or misbehaved - its shard starts over with a new process
+// returns 0 once a shard has used up its attempts (or a replacement can't be started)
+static int worker_lost(Batch *b, int w){
+    int s = b->workers[w].shard;
+    reap_worker(&b->workers[w], 1);
+
+    if (s >= 0){
+        Shard *shard = &b->shards[s];
+        shard->len = 0;
+        shard->count = 0;
+        shard->state = SHARD_QUEUED;
+        if (b->bo->progress){
+            fprintf(stderr, "\nbatch: worker failed on shard %d (attempt %d of %d)\n", s, shard->attempts, BATCH_MAX_ATTEMPTS);
+        }
+        if (shard->attempts >= BATCH_MAX_ATTEMPTS) return 0;
+    }
+    return next_queued(b) < 0 || spawn_worker(b, w);
+}
+
+static int assign(Batch *b, int w){
+    int s = next_queued(b);
+    if (s < 0) return 1;
+
+    Shard *shard = &b->shards[s];
+    shard->state = SHARD_RUNNING;
+    shard->attempts++;
+    b->workers[w].shard = s;
+    b->workers[w].deadline = now_ms() + BATCH_SHARD_TIMEOUT_MS;
+
+    uint8_t *p = b->mb.data + MSG_HEADER;
+    put_u32(p, (uint32_t)s);
+    put_u64(p + 4, shard->begin);
+    put_u64(p + 12, shard->end);
+    if (!send_msg(b->workers[w].fd, &b->mb, MSG_SHARD, 20)) return worker_lost(b, w);
+    return 1;
+}
+
+// writes finished shards in file order, numbering the polylines as it goes
+static int flush_ready(Batch *b){
+    while (b->next_write < b->num_shards && b->shards[b->next_write].state == SHARD_DONE){
+        Shard *shard = &b->shards[b->next_write];
+        size_t start = 0;
+        for (size_t i = 0; i < shard->len; ++i){
+            if (shard->text[i] != '\n') continue;
+            if (fprintf(b->out, "%ld ", b->written++) < 0) return 0;
+            if (fwrite(shard->text + start, 1, i + 1 - start, b->out) != i + 1 - start) return 0;
+            start = i + 1;
+        }
+        free(shard->text);
+        shard->text = NULL;
+        shard->len = shard->cap = 0;
+        b->next_write++;
+    }
+    return 1;
+}
+
+// returns 0 if the message doesn't fit what the worker was asked to do
+static int handle_msg(Batch *b, int w, uint32_t type, const uint8_t *payload, uint32_t len){
+    int s = b->workers[w].shard;
+    if (s < 0 || len < 4 || get_u32(payload) != (uint32_t)s) return 0;
+    Shard *shard = &b->shards[s];
+    const uint8_t *p = payload + 4;
+
+    if (type == MSG_RESULT){
+        if (len < 8) return 0;
+        uint32_t K = get_u32(p);
+        p += 4;
+        if (K > (uint32_t)b->bo->num_terms || len != (K ? 8 + (2 * K + 1) * 16 : 8)) return 0;
+
+        char num[64];
+        int n = snprintf(num, sizeof(num), "%u", K);
+        if (!text_append(shard, num, (size_t)n)) return 0;
+        for (uint32_t k = 0; K > 0 && k <= 2 * K; ++k){
+            n = snprintf(num, sizeof(num), " %.9g %.9g", get_f64(p), get_f64(p + 8));
+            if (!text_append(shard, num, (size_t)n)) return 0;
+            p += 16;
+        }
+        if (!text_append(shard, "\n", 1)) return 0;
+        shard->count++;
+        return 1;
+    }
+
+    if (type == MSG_DONE){
+        if (len != 12 || get_u64(p) != shard->count) return 0;
+        shard->state = SHARD_DONE;
+        b->workers[w].shard = -1;
+        b->num_done++;
+        if (b->bo->progress){
+            fprintf(stderr, "\rbatch: %d/%d shards", b->num_done, b->num_shards);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// takes whatever the worker has sent so far and handles every complete message in it
+// poll said the fd is readable, so the single read here can't block - a worker that stops mid message
+// just leaves a partial one buffered until its deadline runs out
+// returns 0 if the worker is gone or sent something that doesn't fit
+static int read_worker(Batch *b, int w){
+    Worker *wk = &b->workers[w];
+    if (wk->in.cap - wk->have < 65536 && !msg_reserve(&wk->in, wk->have * 2 + 65536)) return 0;
+
+    ssize_t n = read(wk->fd, wk->in.data + wk->have, wk->in.cap - wk->have);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 1;
+    if (n <= 0) return 0;
+    wk->have += (size_t)n;
+
+    size_t pos = 0;
+    while (wk->have - pos >= MSG_HEADER){
+        uint32_t type = get_u32(wk->in.data + pos);
+        uint32_t len = get_u32(wk->in.data + pos + 4);
+        if (len > MSG_MAX_PAYLOAD) return 0;
+        if (wk->have - pos < MSG_HEADER + (size_t)len) break;
+        if (!handle_msg(b, w, type, wk->in.data + pos + MSG_HEADER, len)) return 0;
+        pos += MSG_HEADER + len;
+        wk->deadline = now_ms() + BATCH_SHARD_TIMEOUT_MS; // still making progress
+    }
+    memmove(wk->in.data, wk->in.data + pos, wk->have - pos);
+    wk->have -= pos;
+    return 1;
+}
+
+// ms until the nearest running shard's deadline, -1 (wait forever) if nothing is running
+static int poll_timeout(const Batch *b){
+    double now = now_ms();
+    int timeout = -1;
+    for (int i = 0; i < b->num_workers; ++i){
+        const Worker *w = &b->workers[i];
+        if (w->fd < 0 || w->shard < 0) continue;
+        double left = w->deadline - now;
+        int ms = left > 0.0 ? (int)left + 1 : 0;
+        if (timeout < 0 || ms < timeout) timeout = ms;
+    }
+    return timeout;
+}
+
+long batch_run(const char *input, FILE *out, const BatchOptions *bo){
+    if (!input || !out || !bo || bo->num_workers < 1 || bo->num_terms < 1) return -1;
+
+    FILE *f = fopen(input, "rb");
+    if (!f) return -1;
+    off_t size = -1;
+    if (fseeko(f, 0, SEEK_END) == 0) size = ftello(f);
+    fclose(f);
+    if (size < 0) return -1;
+
+    Batch b;
+    memset(&b, 0, sizeof(b));
+    b.input = input;
+    b.out = out;
+    b.bo = bo;
+
+    b.num_shards = bo->num_workers * BATCH_SHARDS_PER_WORKER;
+    if ((off_t)b.num_shards * BATCH_MIN_SHARD_BYTES > size) b.num_shards = (int)(size / BATCH_MIN_SHARD_BYTES);
+    if (b.num_shards < 1) b.num_shards = 1;
+    b.num_workers = bo->num_workers < b.num_shards ? bo->num_workers : b.num_shards;
+
+    b.shards = calloc((size_t)b.num_shards, sizeof(Shard));
+    b.workers = calloc((size_t)b.num_workers, sizeof(Worker));
+    struct pollfd *fds = calloc((size_t)b.num_workers, sizeof(struct pollfd));
+    int ok = b.shards && b.workers && fds && msg_reserve(&b.mb, MSG_HEADER + 64);
+
+    for (int i = 0; ok && i < b.num_shards; ++i){
+        b.shards[i].begin = (uint64_t)size * (uint64_t)i / (uint64_t)b.num_shards;
+        b.shards[i].end = (uint64_t)size * (uint64_t)(i + 1) / (uint64_t)b.num_shards;
+    }
+
+    // timed once here rather than by every worker at once on busy cores - they inherit the plans through fork,
+    // and the coordinator's table is the one that gets saved as wisdom
+    if (ok) fourier_prepare_plans(2, bo->num_terms, &bo->opts);
+
+    // a dead worker should show up as a failed write, not kill the coordinator
+    struct sigaction ignore, old_pipe;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &old_pipe);
+
+    for (int i = 0; ok && i < b.num_workers; ++i) b.workers[i].fd = -1;
+    for (int i = 0; ok && i < b.num_workers; ++i) ok = spawn_worker(&b, i);
+
+    while (ok && b.num_done < b.num_shards){
+        for (int i = 0; ok && i < b.num_workers; ++i){
+            if (b.workers[i].fd >= 0 && b.workers[i].shard < 0) ok = assign(&b, i);
+        }
+        if (!ok) break;
+
+        for (int i = 0; i < b.num_workers; ++i){
+            fds[i].fd = b.workers[i].fd; // negative fds are skipped by poll
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if (poll(fds, (nfds_t)b.num_workers, poll_timeout(&b)) < 0){
+            if (errno == EINTR) continue;
+            ok = 0;
+            break;
+        }
+
+        for (int i = 0; ok && i < b.num_workers; ++i){
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            if (!read_worker(&b, i)){
+                ok = worker_lost(&b, i);
+                continue;
+            }
+            ok = flush_ready(&b);
+        }
+
+        // a hung worker never closes its socket, so it only shows up here
+        double now = now_ms();
+        for (int i = 0; ok && i < b.num_workers; ++i){
+            Worker *w = &b.workers[i];
+            if (w->fd < 0 || w->shard < 0 || now < w->deadline) continue;
+            if (bo->progress) fprintf(stderr, "\nbatch: no reply on shard %d for %d ms", w->shard, BATCH_SHARD_TIMEOUT_MS);
+            ok = worker_lost(&b, i);
+        }
+    }
+    if (bo->progress) fprintf(stderr, ok ? "\n" : "\nbatch: giving up\n");
+
+    // idle workers get told to stop, anything else (only after a failure) is killed
+    for (int i = 0; b.workers && i < b.num_workers; ++i){
+        Worker *w = &b.workers[i];
+        if (w->fd < 0) continue;
+        int quit = ok && w->shard < 0 && msg_reserve(&b.mb, MSG_HEADER) && send_msg(w->fd, &b.mb, MSG_QUIT, 0);
+        reap_worker(w, !quit);
+    }
+    sigaction(SIGPIPE, &old_pipe, NULL);
+
+    if (ok && fflush(out) != 0) ok = 0;
+    long written = ok ? b.written : -1;
+
+    for (int i = 0; b.shards && i < b.num_shards; ++i) free(b.shards[i].text);
+    for (int i = 0; b.workers && i < b.num_workers; ++i) free(b.workers[i].in.data);
+    free(b.shards);
+    free(b.workers);
+    free(fds);
+    free(b.mb.data);
+    return written;
+}
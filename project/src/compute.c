@@ -0,0 +1,257 @@
+#include "compute.h"
+#include "descriptors.h"
+#include "raster.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REFINE_BUDGET_MS 16.0 // how much refinement goes into each published canvas
+#define IDLE_WAIT_MS 100
+#define ALIGN_CANDIDATES 64 // start points tried when lining up shapes for a morph
+
+static void snapshot_free(StrokeSnapshot *snap){
+    if (!snap) return;
+    polyline_free(&snap->line);
+    free(snap);
+}
+
+// waits for the event loop to take the current front canvas, then flips back to front
+// gives up (returns 0) if a newer stroke arrives or the thread is stopping - that canvas is stale anyway
+static int publish_canvas(ComputeThread *ct, int back){
+    while (SDL_AtomicGet(&ct->fresh)){
+        if (!SDL_AtomicGet(&ct->running)) return 0;
+        if (SDL_AtomicGetPtr(&ct->mailbox)) return 0;
+        SDL_Delay(1);
+    }
+    SDL_AtomicSet(&ct->front, back);
+    SDL_AtomicSet(&ct->fresh, 1);
+    return 1;
+}
+
+// descriptors kept from one 2D stroke to the next so the new one can morph out of the old
+typedef struct {
+    complex_t *from; // shape being morphed away from
+    int K_from;
+    complex_t *last; // most recent finished shape
+    int K_last;
+    complex_t *blended;
+    int frame; // 0 when not morphing
+} MorphState;
+
+static void morph_free(MorphState *ms){
+    free(ms->from);
+    free(ms->last);
+    free(ms->blended);
+    ms->from = NULL;
+    ms->last = NULL;
+    ms->blended = NULL;
+    ms->frame = 0;
+}
+
+// sets up a morph from whatever is on screen into the shape progress just started
+// returns 1 if there's something to morph from
+static int morph_begin(MorphState *ms, Fourier2DProgress *fp){
+    int K = fp->K;
+    complex_t *copy = malloc(sizeof(complex_t) * (2 * K + 1));
+    if (!copy) return 0;
+
+    if (ms->frame > 1){
+        // cut off mid morph - carry on from the tween that was last drawn, not the shape it was heading for
+        free(ms->from);
+        free(ms->last);
+        ms->from = ms->blended;
+        ms->K_from = ms->K_last > ms->K_from ? ms->K_last : ms->K_from;
+        ms->blended = NULL;
+    } else if (ms->frame == 1){
+        // no tween drawn yet so from is still what's showing
+        free(ms->last);
+    } else {
+        free(ms->from);
+        ms->from = ms->last;
+        ms->K_from = ms->K_last;
+    }
+    ms->last = NULL;
+
+    if (ms->from){
+        // same start point stops the tween from spinning
+        descriptors_align_start(ms->from, ms->K_from, fp->descriptors, K, ALIGN_CANDIDATES);
+    }
+    memcpy(copy, fp->descriptors, sizeof(complex_t) * (2 * K + 1));
+
+    ms->last = copy;
+    ms->K_last = K;
+    ms->frame = 0;
+    if (!ms->from) return 0;
+
+    int K_max = K > ms->K_from ? K : ms->K_from;
+    free(ms->blended);
+    ms->blended = malloc(sizeof(complex_t) * (2 * K_max + 1));
+    if (!ms->blended) return 0;
+
+    ms->frame = 1;
+    return 1;
+}
+
+// draws the next tween frame, returns 1 once the morph has reached the new shape
+static int morph_step(MorphState *ms, int num_frames, const Fourier2DProgress *fp, uint8_t *canvas){
+    double t = (double)ms->frame / (double)num_frames;
+    t = t * t * (3.0 - 2.0 * t); // ease in and out
+
+    descriptors_blend(ms->from, ms->K_from, ms->last, ms->K_last, t, ms->blended);
+    int K_max = ms->K_last > ms->K_from ? ms->K_last : ms->K_from;
+    fourier_2d_from_descriptors(canvas, ms->blended, K_max, fp->spaced_pts, fp->num_pts);
+
+    if (ms->frame >= num_frames){
+        ms->frame = 0;
+        return 1;
+    }
+    ms->frame++;
+    return 0;
+}
+
+static int compute_main(void *data){
+    ComputeThread *ct = (ComputeThread *)data;
+
+    StrokeSnapshot *snap = NULL;
+    int work_done = 1;
+
+    Fourier2DProgress progress;
+    fourier_2d_progress_init(&progress);
+
+    MorphState morph = {NULL, 0, NULL, 0, NULL, 0};
+
+    while (SDL_AtomicGet(&ct->running)){
+        // latest stroke wins - anything older was never taken out of the slot
+        StrokeSnapshot *next = (StrokeSnapshot *)SDL_AtomicSetPtr(&ct->mailbox, NULL);
+        if (next){
+            snapshot_free(snap);
+            snap = next;
+            work_done = 0;
+            if (snap->dimension == 2){
+                if (!fourier_2d_progress_start(&progress, snap->num_terms, &snap->line, &snap->opts)){
+                    work_done = 1;
+                    SDL_AtomicSet(&ct->finished, snap->seq); // nothing to draw
+                } else if (ct->morph_frames > 0){
+                    morph_begin(&morph, &progress);
+                }
+            }
+        }
+
+        if (!snap || work_done){
+            SDL_SemWaitTimeout(ct->wake, IDLE_WAIT_MS);
+            continue;
+        }
+
+        // only this thread writes front, so back can't be in use by the event loop
+        int back = 1 - SDL_AtomicGet(&ct->front);
+        uint8_t *canvas = ct->canvases[back];
+
+        if (snap->dimension == 1){
+            raster_clear(canvas);
+            raster_polyline(canvas, &snap->line, 255); // white line colour
+            fourier_1d(canvas, RASTER_SIZE, RASTER_SIZE, snap->num_terms, &snap->opts);
+            work_done = 1;
+        } else if (morph.frame > 0){
+            // O(K) blend per frame, the final frame is the new shape in full
+            work_done = morph_step(&morph, ct->morph_frames, &progress, canvas);
+        } else {
+            fourier_2d_progress_step(&progress, canvas, REFINE_BUDGET_MS);
+            work_done = fourier_2d_progress_done(&progress);
+        }
+
+        if (!publish_canvas(ct, back)){
+            work_done = 1; // newer stroke (or shutdown) takes over
+        } else if (work_done){
+            SDL_AtomicSet(&ct->finished, snap->seq);
+        }
+    }
+
+    morph_free(&morph);
+    fourier_2d_progress_free(&progress);
+    snapshot_free(snap);
+    return 0;
+}
+
+int compute_start(ComputeThread *ct, int morph_frames){
+    memset(ct, 0, sizeof(*ct));
+    ct->morph_frames = morph_frames;
+
+    ct->canvases[0] = calloc(RASTER_SIZE * RASTER_SIZE, sizeof(uint8_t));
+    ct->canvases[1] = calloc(RASTER_SIZE * RASTER_SIZE, sizeof(uint8_t));
+    ct->wake = SDL_CreateSemaphore(0);
+    if (!ct->canvases[0] || !ct->canvases[1] || !ct->wake){
+        compute_stop(ct);
+        return 0;
+    }
+
+    SDL_AtomicSet(&ct->front, 0);
+    SDL_AtomicSet(&ct->fresh, 0);
+    SDL_AtomicSet(&ct->published, 0);
+    SDL_AtomicSet(&ct->finished, 0);
+    SDL_AtomicSet(&ct->running, 1);
+
+    ct->thread = SDL_CreateThread(compute_main, "fourier", ct);
+    if (!ct->thread){
+        compute_stop(ct);
+        return 0;
+    }
+    return 1;
+}
+
+void compute_stop(ComputeThread *ct){
+    SDL_AtomicSet(&ct->running, 0);
+    if (ct->thread){
+        SDL_SemPost(ct->wake);
+        SDL_WaitThread(ct->thread, NULL);
+        ct->thread = NULL;
+    }
+
+    snapshot_free((StrokeSnapshot *)SDL_AtomicSetPtr(&ct->mailbox, NULL));
+
+    if (ct->wake) SDL_DestroySemaphore(ct->wake);
+    ct->wake = NULL;
+    free(ct->canvases[0]);
+    free(ct->canvases[1]);
+    ct->canvases[0] = NULL;
+    ct->canvases[1] = NULL;
+}
+
+int compute_publish(ComputeThread *ct, const Polyline *pl, int dimension, int num_terms, const FourierOptions *opts){
+    StrokeSnapshot *snap = malloc(sizeof(StrokeSnapshot));
+    if (!snap) return 0;
+
+    polyline_init(&snap->line);
+    if (!polyline_reserve(&snap->line, pl->len)){
+        free(snap);
+        return 0;
+    }
+    memcpy(snap->line.pts, pl->pts, pl->len * sizeof(Vec2));
+    snap->line.len = pl->len;
+    snap->dimension = dimension;
+    snap->num_terms = num_terms;
+    if (opts) {
+        snap->opts = *opts;
+    } else {
+        fourier_options_default(&snap->opts);
+    }
+
+    snap->seq = SDL_AtomicAdd(&ct->published, 1) + 1;
+
+    // thread never saw the old one, so it's ours to free
+    snapshot_free((StrokeSnapshot *)SDL_AtomicSetPtr(&ct->mailbox, snap));
+    SDL_SemPost(ct->wake);
+    return 1;
+}
+
+int compute_idle(ComputeThread *ct){
+    return SDL_AtomicGet(&ct->finished) == SDL_AtomicGet(&ct->published);
+}
+
+const uint8_t *compute_acquire(ComputeThread *ct){
+    if (!SDL_AtomicGet(&ct->fresh)) return NULL;
+    return ct->canvases[SDL_AtomicGet(&ct->front)];
+}
+
+void compute_release(ComputeThread *ct){
+    SDL_AtomicSet(&ct->fresh, 0);
+}
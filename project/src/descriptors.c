@@ -0,0 +1,81 @@
+#include "descriptors.h"
+
+#include <math.h>
+
+void descriptors_translate(complex_t *d, int K, double dx, double dy){
+    d[K].re += dx;
+    d[K].im += dy;
+}
+
+void descriptors_scale_rotate(complex_t *d, int K, double scale, double angle){
+    double m_re = scale * cos(angle);
+    double m_im = scale * sin(angle);
+    for (int i = 0; i < 2 * K + 1; ++i){
+        if (i == K) continue; // centroid stays put
+        double re = d[i].re * m_re - d[i].im * m_im;
+        double im = d[i].re * m_im + d[i].im * m_re;
+        d[i].re = re;
+        d[i].im = im;
+    }
+}
+
+void descriptors_shift_start(complex_t *d, int K, double tau){
+    for (int k = -K; k <= K; ++k){
+        if (k == 0) continue;
+        double theta = 2.0 * M_PI * (double)k * tau;
+        double c = cos(theta);
+        double s = sin(theta);
+        complex_t v = d[k+K];
+        d[k+K].re = v.re * c - v.im * s;
+        d[k+K].im = v.re * s + v.im * c;
+    }
+}
+
+// kth coefficient or zero if k is past K
+static complex_t coeff_or_zero(const complex_t *d, int K, int k){
+    if (k < -K || k > K){
+        complex_t zero = {0.0, 0.0};
+        return zero;
+    }
+    return d[k+K];
+}
+
+void descriptors_blend(const complex_t *a, int Ka, const complex_t *b, int Kb, double t, complex_t *out){
+    int K = Ka > Kb ? Ka : Kb;
+    for (int k = -K; k <= K; ++k){
+        complex_t ca = coeff_or_zero(a, Ka, k);
+        complex_t cb = coeff_or_zero(b, Kb, k);
+        out[k+K].re = (1.0 - t) * ca.re + t * cb.re;
+        out[k+K].im = (1.0 - t) * ca.im + t * cb.im;
+    }
+}
+
+double descriptors_align_start(const complex_t *ref, int K_ref, complex_t *d, int K, int num_candidates){
+    if (num_candidates < 1) return 0.0;
+
+    int K_common = K < K_ref ? K : K_ref;
+    double best_tau = 0.0;
+    double best_dist = HUGE_VAL;
+
+    // centroids don't depend on the start, so only compare k != 0
+    for (int j = 0; j < num_candidates; ++j){
+        double tau = (double)j / (double)num_candidates;
+        double dist = 0.0;
+        for (int k = -K_common; k <= K_common; ++k){
+            if (k == 0) continue;
+            double theta = 2.0 * M_PI * (double)k * tau;
+            complex_t v = d[k+K];
+            complex_t r = ref[k+K_ref];
+            double re = v.re * cos(theta) - v.im * sin(theta) - r.re;
+            double im = v.re * sin(theta) + v.im * cos(theta) - r.im;
+            dist += re * re + im * im;
+        }
+        if (dist < best_dist){
+            best_dist = dist;
+            best_tau = tau;
+        }
+    }
+
+    descriptors_shift_start(d, K, best_tau);
+    return best_tau;
+}
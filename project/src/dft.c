@@ -0,0 +1,200 @@
+#include "dft.h"
+
+#include <math.h>
+
+#include "codelets.h" // generated into bin/gen by the makefile
+
+int is_power_of_two(size_t n){
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+size_t fft_specialized_size(size_t n){
+    if (n <= CODELET_MIN_SIZE) return CODELET_MIN_SIZE;
+    if (n >= CODELET_MAX_SIZE) return CODELET_MAX_SIZE;
+    size_t lo = CODELET_MIN_SIZE;
+    while (lo * 2 <= n) lo *= 2;
+    return (n - lo < lo * 2 - n) ? lo : lo * 2;
+}
+
+// --- goertzel ---
+
+// runs the recurrence s[n] = x[n] + 2cos(w) s[n-1] - s[n-2] over N samples (stride apart)
+// and returns X_k = sum x[n] e^{-i w n} for w = 2 pi k / N
+static complex_t goertzel(const double *x, size_t N, int k){
+    double w = 2.0 * M_PI * (double)k / (double)N;
+    double coeff = 2.0 * cos(w);
+    double s1 = 0.0;
+    double s2 = 0.0;
+    for (size_t n = 0; n < N; ++n){
+        double s0 = x[n] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    // one extra zero sample then y = s[N] - e^{-iw} s[N-1], which is X_k since w N = 2 pi k
+    double sN = coeff * s1 - s2;
+    complex_t X = {sN - cos(w) * s1, sin(w) * s1};
+    return X;
+}
+
+void dft_real_coeffs_goertzel(const float *f, size_t N, int K, double *a0_out, double *a, double *b){
+    double *x = malloc(sizeof(double) * N);
+    if (!x){ // fall back rather than fail
+        dft_real_coeffs(f, N, K, a0_out, a, b);
+        return;
+    }
+
+    double a0 = 0.0;
+    for (size_t n = 0; n < N; ++n){
+        x[n] = (double)f[n];
+        a0 += x[n];
+    }
+    *a0_out = a0 / (double)N;
+
+    const double scale = 2.0 / (double)N;
+    for (int k = 1; k <= K; ++k){
+        complex_t X = goertzel(x, N, k);
+        a[k-1] = scale * X.re; // sum f cos
+        b[k-1] = -scale * X.im; // sum f sin
+    }
+    free(x);
+}
+
+void compute_fourier_descriptors_goertzel(const Pt *input, size_t num_pts, int K, complex_t *output){
+    double *xs = malloc(sizeof(double) * 2 * num_pts);
+    if (!xs){
+        compute_fourier_descriptors(input, num_pts, K, output);
+        return;
+    }
+    double *ys = xs + num_pts;
+
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (size_t i = 0; i < num_pts; ++i){
+        mean_x += input[i].x;
+        mean_y += input[i].y;
+    }
+    mean_x /= num_pts;
+    mean_y /= num_pts;
+
+    for (size_t i = 0; i < num_pts; ++i){
+        xs[i] = input[i].x - mean_x;
+        ys[i] = input[i].y - mean_y;
+    }
+
+    output[K].re = mean_x;
+    output[K].im = mean_y;
+
+    // x and y are real, so one pass each gives +k and -k (conjugates)
+    for (int k = 1; k <= K; ++k){
+        complex_t X = goertzel(xs, num_pts, k);
+        complex_t Y = goertzel(ys, num_pts, k);
+        // c_k = (X + iY) / N, c_-k = (conj X + i conj Y) / N
+        output[K+k].re = (X.re - Y.im) / num_pts;
+        output[K+k].im = (X.im + Y.re) / num_pts;
+        output[K-k].re = (X.re + Y.im) / num_pts;
+        output[K-k].im = (Y.re - X.im) / num_pts;
+    }
+    free(xs);
+}
+
+// --- fft ---
+
+void fft_complex(double *re, double *im, size_t N){
+    FftCodelet codelet = fft_codelet(N);
+    if (codelet){
+        codelet(re, im);
+        return;
+    }
+
+    // bit reversal permutation
+    for (size_t i = 1, j = 0; i < N; ++i){
+        size_t bit = N >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j){
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    // butterflies, twiddle advanced by rotation within each stage
+    for (size_t len = 2; len <= N; len <<= 1){
+        double angle = -2.0 * M_PI / (double)len;
+        double w_re = cos(angle);
+        double w_im = sin(angle);
+        for (size_t start = 0; start < N; start += len){
+            double t_re = 1.0;
+            double t_im = 0.0;
+            for (size_t j = 0; j < len / 2; ++j){
+                size_t u = start + j;
+                size_t v = u + len / 2;
+                double v_re = re[v] * t_re - im[v] * t_im;
+                double v_im = re[v] * t_im + im[v] * t_re;
+                re[v] = re[u] - v_re;
+                im[v] = im[u] - v_im;
+                re[u] += v_re;
+                im[u] += v_im;
+                double next = t_re * w_re - t_im * w_im;
+                t_im = t_re * w_im + t_im * w_re;
+                t_re = next;
+            }
+        }
+    }
+}
+
+int dft_real_coeffs_fft(const float *f, size_t N, int K, double *a0_out, double *a, double *b){
+    if (!is_power_of_two(N)) return 0;
+
+    double *re = malloc(sizeof(double) * 2 * N);
+    if (!re) return 0;
+    double *im = re + N;
+
+    for (size_t n = 0; n < N; ++n){
+        re[n] = (double)f[n];
+        im[n] = 0.0;
+    }
+    fft_complex(re, im, N);
+
+    *a0_out = re[0] / (double)N;
+    const double scale = 2.0 / (double)N;
+    for (int k = 1; k <= K; ++k){
+        a[k-1] = scale * re[k];
+        b[k-1] = -scale * im[k];
+    }
+    free(re);
+    return 1;
+}
+
+int compute_fourier_descriptors_fft(const Pt *input, size_t num_pts, int K, complex_t *output){
+    if (!is_power_of_two(num_pts) || (size_t)(2 * K + 1) > num_pts) return 0;
+
+    double *re = malloc(sizeof(double) * 2 * num_pts);
+    if (!re) return 0;
+    double *im = re + num_pts;
+
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (size_t i = 0; i < num_pts; ++i){
+        mean_x += input[i].x;
+        mean_y += input[i].y;
+    }
+    mean_x /= num_pts;
+    mean_y /= num_pts;
+
+    for (size_t i = 0; i < num_pts; ++i){
+        re[i] = input[i].x - mean_x;
+        im[i] = input[i].y - mean_y;
+    }
+    fft_complex(re, im, num_pts);
+
+    output[K].re = mean_x;
+    output[K].im = mean_y;
+    for (int k = 1; k <= K; ++k){
+        output[K+k].re = re[k] / num_pts;
+        output[K+k].im = im[k] / num_pts;
+        output[K-k].re = re[num_pts - k] / num_pts; // negative frequencies wrap to the top
+        output[K-k].im = im[num_pts - k] / num_pts;
+    }
+    free(re);
+    return 1;
+}
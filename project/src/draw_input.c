@@ -6,46 +6,54 @@
 #include <math.h>
 
 void draw_input_init(DrawInput *di){
+    point_store_init(&di->store);
     polyline_init(&di->line);
 
     di->is_drawing = 0;
     di->min_dist = MIN_DIST;
     di->max_pts = MAX_PTS; // NB set to zero for unlimited
+    di->version = 0;
+    di->strokes = 0;
 
 
 }
 
 void draw_input_free(DrawInput *di){
+    point_store_free(&di->store);
     polyline_free(&di->line);
     di->is_drawing = 0;
 }
 
+// memory is kept for the next stroke - chunks go back on the store's free list
 void draw_input_clear(DrawInput *di){
-    //polyline_clear(&di->line);
-    polyline_free(&di->line);
-    polyline_init(&di->line);
+    point_store_clear(&di->store);
+    polyline_clear(&di->line);
     di->is_drawing = 0;
+    di->version++;
+    di->strokes++;
 }
 
 
 // what if this fails? consider backup options
 void try_add_point(DrawInput *di, float x, float y){
     if(!di) return;
-    if(di->max_pts && di->line.len >= di->max_pts){ // too many points
-        //fprintf(stderr, "[warning] polyline point cap reached (%zu)\n", di->line.len);
+    if(di->max_pts && di->store.len >= di->max_pts){ // too many points
+        //fprintf(stderr, "[warning] polyline point cap reached (%zu)\n", di->store.len);
         di->is_drawing = 0;
         return;
     }
     Vec2 p = {x, y};
-    if (di->line.len > 0){
-        Vec2 last = di->line.pts[di->line.len - 1];
+    if (di->store.len > 0){
+        Vec2 last = point_store_get(&di->store, di->store.len - 1);
         float add_dist = vec2_dist(last, p);
         if (add_dist < di->min_dist) return;
     }
-    if(!polyline_push(&di->line, p)){
+    if(!point_store_push(&di->store, p)){
         //fprintf(stderr, "[error] out of memory adding point at %.1f,%.1f\n", x, y);
         di->is_drawing = 0;
+        return;
     }
+    di->version++;
     
 }
 
@@ -57,7 +65,6 @@ void draw_input_handling(DrawInput *di, const SDL_Event *e){
             if(e->button.button == SDL_BUTTON_LEFT){
                 draw_input_clear(di); // only one line at a time
                 di->is_drawing = 1;
-                polyline_reserve(&di->line, 50000); // precautionary
                 try_add_point(di, (float)e->button.x, (float)e->button.y);
             }
             break;
@@ -78,8 +85,7 @@ void draw_input_handling(DrawInput *di, const SDL_Event *e){
     }
 }
 
-
-
-
-
-
+const Polyline *draw_input_polyline(DrawInput *di){
+    if (!point_store_view(&di->store, &di->line)) return NULL;
+    return &di->line;
+}
@@ -0,0 +1,113 @@
+#include "elliptic.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// https://www.sci.utah.edu/~gerig/CS7960-S2010/handouts/Kuhl-Giardina-CGIP1982.pdf
+// for segment p running from t_{p-1} to t_p (arclength, T total) with steps dx_p, dy_p, dt_p:
+//   a_n = T / (2 n^2 pi^2) * sum_p dx_p / dt_p * (cos(phi_p) - cos(phi_{p-1}))
+//   b_n = T / (2 n^2 pi^2) * sum_p dx_p / dt_p * (sin(phi_p) - sin(phi_{p-1}))
+//   c_n, d_n the same with dy_p,  phi_p = 2 n pi t_p / T
+// x(t) = A0 + sum a_n cos + b_n sin, y(t) = C0 + sum c_n cos + d_n sin
+// the complex descriptors are then c_{+n} = ((a + d) + i(c - b)) / 2 and c_{-n} = ((a - d) + i(c + b)) / 2
+
+// fills cos(k phi), sin(k phi) for k = 1..K by repeated rotation - avoids trig calls in the inner loop
+static void harmonic_phases(double phi, int K, double *cos_out, double *sin_out){
+    double c1 = cos(phi);
+    double s1 = sin(phi);
+    double c = c1;
+    double s = s1;
+    for (int k = 1; k <= K; ++k){
+        cos_out[k-1] = c;
+        sin_out[k-1] = s;
+        double c_next = c * c1 - s * s1;
+        s = s * c1 + c * s1;
+        c = c_next;
+    }
+}
+
+int elliptic_descriptors(const Polyline *pl, int K, complex_t *output){
+    if (!pl || !pl->pts || pl->len < 2 || K < 0 || !output) return 0;
+
+    const Vec2 *pts = pl->pts;
+    size_t num_pts = pl->len;
+
+    // total length (including closing segment) is needed before any phase can be computed
+    double total_length = 0.0;
+    for (size_t i = 0; i < num_pts; ++i){
+        Vec2 A = pts[i];
+        Vec2 B = pts[(i + 1) % num_pts];
+        total_length += hypot((double)B.x - A.x, (double)B.y - A.y);
+    }
+    if (total_length < DBL_EPSILON) return 0;
+
+    // a, b, c, d sums plus phase tables for the start and end of the current segment
+    double *work = calloc(8 * (size_t)(K > 0 ? K : 1), sizeof(double));
+    if (!work) return 0;
+    double *a = work;
+    double *b = a + K;
+    double *c = b + K;
+    double *d = c + K;
+    double *cos_prev = d + K;
+    double *sin_prev = cos_prev + K;
+    double *cos_curr = sin_prev + K;
+    double *sin_curr = cos_curr + K;
+
+    const double phase_scale = 2.0 * M_PI / total_length;
+
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    double t = 0.0;
+
+    harmonic_phases(0.0, K, cos_prev, sin_prev);
+
+    for (size_t i = 0; i < num_pts; ++i){
+        Vec2 A = pts[i];
+        Vec2 B = pts[(i + 1) % num_pts];
+        double dx = (double)B.x - A.x;
+        double dy = (double)B.y - A.y;
+        double dt = hypot(dx, dy);
+        if (dt < DBL_EPSILON) continue; // repeated point, contributes nothing
+
+        // centroid along the curve is exact for straight segments
+        mean_x += dt * 0.5 * ((double)A.x + B.x);
+        mean_y += dt * 0.5 * ((double)A.y + B.y);
+
+        t += dt;
+        harmonic_phases(phase_scale * t, K, cos_curr, sin_curr);
+
+        double slope_x = dx / dt;
+        double slope_y = dy / dt;
+        for (int k = 0; k < K; ++k){
+            double d_cos = cos_curr[k] - cos_prev[k];
+            double d_sin = sin_curr[k] - sin_prev[k];
+            a[k] += slope_x * d_cos;
+            b[k] += slope_x * d_sin;
+            c[k] += slope_y * d_cos;
+            d[k] += slope_y * d_sin;
+        }
+
+        // end of this segment is the start of the next
+        double *swap = cos_prev; cos_prev = cos_curr; cos_curr = swap;
+        swap = sin_prev; sin_prev = sin_curr; sin_curr = swap;
+    }
+
+    output[K].re = mean_x / total_length;
+    output[K].im = mean_y / total_length;
+
+    for (int k = 1; k <= K; ++k){
+        double scale = total_length / (2.0 * k * k * M_PI * M_PI);
+        double an = scale * a[k-1];
+        double bn = scale * b[k-1];
+        double cn = scale * c[k-1];
+        double dn = scale * d[k-1];
+
+        output[K+k].re = 0.5 * (an + dn);
+        output[K+k].im = 0.5 * (cn - bn);
+        output[K-k].re = 0.5 * (an - dn);
+        output[K-k].im = 0.5 * (cn + bn);
+    }
+
+    free(work);
+    return 1;
+}
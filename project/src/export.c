@@ -0,0 +1,302 @@
+#include "export.h"
+
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include "raster.h"
+
+#define EXPORT_MAX_SAMPLES 16384 // reconstruction cap per frame (same as the live 2D path)
+#define RING_PER_THREAD 2 // canvases per render thread, so a worker rarely waits on the writer
+
+// layout:
+// frames are claimed in order by the render threads, and frame f always lands in ring slot f % ring_len
+// a worker can only start frame f once the writer is done with frame f - ring_len (the slot's last user),
+// so at most ring_len frames are ever in memory no matter how long the animation is
+// the calling thread is the single writer - it takes slots strictly in order, so output order never depends on scheduling
+
+typedef struct {
+    uint8_t canvas[RASTER_SIZE * RASTER_SIZE];
+    uint8_t *bytes; // encoded frame (header included), written as one block
+    size_t num_bytes;
+    long frame; // frame held once ready
+    int ready;
+} ExportSlot;
+
+typedef struct {
+    const complex_t *descriptors;
+    int K;
+    const Pt *outline;
+    size_t num_outline;
+    const ExportOptions *eo;
+    long num_frames;
+    Pt *path; // full reconstruction, trace mode only (shared, read only)
+    size_t num_path;
+
+    ExportSlot *ring;
+    int ring_len;
+
+    SDL_mutex *lock; // guards everything below
+    SDL_cond *changed; // a slot became ready or free
+    long next_frame; // next frame for a worker to claim
+    long written; // frames the writer has finished
+    int failed;
+} ExportJob;
+
+typedef struct {
+    ExportJob *job;
+    Pt *samples; // scratch, EXPORT_MAX_SAMPLES
+} ExportWorker;
+
+void export_options_default(ExportOptions *eo){
+    eo->mode = EXPORT_PROGRESSIVE;
+    eo->format = EXPORT_Y4M;
+    eo->num_frames = EXPORT_TRACE_FRAMES;
+    eo->num_threads = 0;
+}
+
+ExportFormat export_format_from_name(const char *filename){
+    size_t len = strlen(filename);
+    if (len >= 4 && strcmp(filename + len - 4, ".y4m") == 0) return EXPORT_Y4M;
+    return EXPORT_PGM;
+}
+
+// --- frame rendering ---
+
+static void render_progressive(const ExportJob *job, long frame, uint8_t *canvas, Pt *samples){
+    int k = (int)frame + 1;
+    const complex_t *sub = job->descriptors + (job->K - k); // first k harmonics, still centred
+    size_t num_samples = adaptive_num_samples(sub, k, EXPORT_MAX_SAMPLES);
+    reconstruct_series_2d(sub, k, num_samples, samples);
+
+    raster_clear(canvas);
+    if (job->outline) raster_closed_line_from_pts(canvas, job->outline, job->num_outline, 2);
+    raster_closed_line_from_pts(canvas, samples, num_samples, 1);
+}
+
+static void render_trace(const ExportJob *job, long frame, uint8_t *canvas){
+    const complex_t *c = job->descriptors;
+    int K = job->K;
+    double t = (double)(frame + 1) / (double)job->num_frames;
+
+    // pen path so far
+    size_t drawn = (size_t)(t * (double)job->num_path);
+    if (drawn > job->num_path) drawn = job->num_path;
+
+    raster_clear(canvas);
+    raster_open_line_from_pts(canvas, job->path, drawn, 1);
+
+    // epicycles from the centroid, +k then -k for each k, each arm turning at its own frequency
+    double x = c[K].re;
+    double y = c[K].im;
+    double theta = 2.0 * M_PI * t;
+    for (int k = 1; k <= K; ++k){
+        for (int sign = 1; sign >= -1; sign -= 2){
+            complex_t ck = c[K + sign * k];
+            double angle = theta * (double)(sign * k);
+            double nx = x + ck.re * cos(angle) - ck.im * sin(angle);
+            double ny = y + ck.re * sin(angle) + ck.im * cos(angle);
+            double radius = hypot(ck.re, ck.im);
+            if (radius >= 1.0) raster_circle(canvas, x, y, radius, 2);
+            raster_line(canvas, (int)lround(x), (int)lround(y), (int)lround(nx), (int)lround(ny), 2);
+            x = nx;
+            y = ny;
+        }
+    }
+}
+
+// --- encoding ---
+
+// same colours as the live window: approximation white, original/epicycles red (full range bt601)
+#define RED_Y 76
+#define RED_U 85
+#define RED_V 255
+
+static size_t frame_size(ExportFormat format){
+    size_t pixels = RASTER_SIZE * RASTER_SIZE;
+    if (format == EXPORT_Y4M) return strlen("FRAME\n") + pixels + pixels / 2;
+    return 32 + pixels; // pgm header is shorter than 32
+}
+
+static size_t encode_frame(ExportFormat format, const uint8_t *canvas, uint8_t *out){
+    static const uint8_t luma[3] = {0, 255, RED_Y};
+    size_t n = 0;
+
+    if (format == EXPORT_PGM){
+        n = (size_t)sprintf((char *)out, "P5\n%d %d\n255\n", RASTER_SIZE, RASTER_SIZE);
+        for (size_t i = 0; i < RASTER_SIZE * RASTER_SIZE; ++i) out[n++] = luma[canvas[i] % 3];
+        return n;
+    }
+
+    memcpy(out, "FRAME\n", 6);
+    n = 6;
+    for (size_t i = 0; i < RASTER_SIZE * RASTER_SIZE; ++i) out[n++] = luma[canvas[i] % 3];
+
+    // chroma is one sample per 2x2 block - red if any of the four is red so thin lines keep their colour
+    uint8_t *u = out + n;
+    uint8_t *v = u + (RASTER_SIZE / 2) * (RASTER_SIZE / 2);
+    for (int y = 0; y < RASTER_SIZE; y += 2){
+        for (int x = 0; x < RASTER_SIZE; x += 2){
+            const uint8_t *p = canvas + y * RASTER_SIZE + x;
+            int red = p[0] == 2 || p[1] == 2 || p[RASTER_SIZE] == 2 || p[RASTER_SIZE + 1] == 2;
+            *u++ = red ? RED_U : 128;
+            *v++ = red ? RED_V : 128;
+        }
+    }
+    return n + (size_t)(RASTER_SIZE / 2) * (RASTER_SIZE / 2) * 2;
+}
+
+// --- threads ---
+
+static int export_worker_main(void *data){
+    ExportWorker *w = (ExportWorker *)data;
+    ExportJob *job = w->job;
+
+    while (1){
+        SDL_LockMutex(job->lock);
+        if (job->failed || job->next_frame >= job->num_frames){
+            SDL_UnlockMutex(job->lock);
+            break;
+        }
+        long frame = job->next_frame++;
+        // slot is free once the writer is past whoever used it last
+        while (!job->failed && job->written + job->ring_len <= frame) SDL_CondWait(job->changed, job->lock);
+        int failed = job->failed;
+        SDL_UnlockMutex(job->lock);
+        if (failed) break;
+
+        ExportSlot *slot = &job->ring[frame % job->ring_len];
+        if (job->eo->mode == EXPORT_TRACE) render_trace(job, frame, slot->canvas);
+        else render_progressive(job, frame, slot->canvas, w->samples);
+        slot->num_bytes = encode_frame(job->eo->format, slot->canvas, slot->bytes);
+
+        SDL_LockMutex(job->lock);
+        slot->frame = frame;
+        slot->ready = 1;
+        SDL_CondBroadcast(job->changed);
+        SDL_UnlockMutex(job->lock);
+    }
+    return 0;
+}
+
+static void fail(ExportJob *job){
+    SDL_LockMutex(job->lock);
+    job->failed = 1;
+    SDL_CondBroadcast(job->changed);
+    SDL_UnlockMutex(job->lock);
+}
+
+// writes frames in order as the workers finish them
+static long write_frames(ExportJob *job, FILE *out){
+    for (long frame = 0; frame < job->num_frames; ++frame){
+        ExportSlot *slot = &job->ring[frame % job->ring_len];
+
+        SDL_LockMutex(job->lock);
+        while (!job->failed && !(slot->ready && slot->frame == frame)) SDL_CondWait(job->changed, job->lock);
+        int failed = job->failed;
+        SDL_UnlockMutex(job->lock);
+        if (failed) return -1;
+
+        if (fwrite(slot->bytes, 1, slot->num_bytes, out) != slot->num_bytes){
+            fail(job);
+            return -1;
+        }
+
+        SDL_LockMutex(job->lock);
+        slot->ready = 0;
+        job->written = frame + 1;
+        SDL_CondBroadcast(job->changed);
+        SDL_UnlockMutex(job->lock);
+    }
+    return job->num_frames;
+}
+
+long export_animation(const char *filename, const complex_t *descriptors, int K, const Pt *outline, size_t num_outline, const ExportOptions *eo){
+    if (!filename || !descriptors || K < 1 || !eo) return -1;
+
+    ExportJob job;
+    job.descriptors = descriptors;
+    job.K = K;
+    job.outline = outline;
+    job.num_outline = num_outline;
+    job.eo = eo;
+    job.num_frames = eo->mode == EXPORT_TRACE ? eo->num_frames : K;
+    job.path = NULL;
+    job.num_path = 0;
+    job.next_frame = 0;
+    job.written = 0;
+    job.failed = 0;
+    if (job.num_frames < 1) return -1;
+
+    int num_threads = eo->num_threads > 0 ? eo->num_threads : SDL_GetCPUCount();
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > job.num_frames) num_threads = (int)job.num_frames;
+    job.ring_len = num_threads * RING_PER_THREAD;
+
+    FILE *out = fopen(filename, "wb");
+    if (!out) return -1;
+
+    // big stdio buffer so the writer issues few large writes - has to be set before anything is written
+    char *write_buffer = malloc(EXPORT_WRITE_BUFFER);
+    if (write_buffer) setvbuf(out, write_buffer, _IOFBF, EXPORT_WRITE_BUFFER);
+
+    if (eo->format == EXPORT_Y4M){
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", RASTER_SIZE, RASTER_SIZE, EXPORT_FPS);
+    }
+
+    job.ring = calloc((size_t)job.ring_len, sizeof(ExportSlot));
+    ExportWorker *workers = calloc((size_t)num_threads, sizeof(ExportWorker));
+    SDL_Thread **threads = calloc((size_t)num_threads, sizeof(SDL_Thread *));
+    job.lock = SDL_CreateMutex();
+    job.changed = SDL_CreateCond();
+
+    int ok = job.ring && workers && threads && job.lock && job.changed;
+    for (int i = 0; ok && i < job.ring_len; ++i){
+        job.ring[i].bytes = malloc(frame_size(eo->format));
+        ok = job.ring[i].bytes != NULL;
+    }
+    for (int i = 0; ok && i < num_threads; ++i){
+        workers[i].job = &job;
+        workers[i].samples = malloc(sizeof(Pt) * EXPORT_MAX_SAMPLES);
+        ok = workers[i].samples != NULL;
+    }
+
+    // every trace frame shows part of the same path, so it's only reconstructed once
+    if (ok && eo->mode == EXPORT_TRACE){
+        job.num_path = adaptive_num_samples(descriptors, K, EXPORT_MAX_SAMPLES);
+        job.path = malloc(sizeof(Pt) * job.num_path);
+        ok = job.path != NULL;
+        if (ok) reconstruct_series_2d(descriptors, K, job.num_path, job.path);
+    }
+
+    int started = 0;
+    while (ok && started < num_threads){
+        threads[started] = SDL_CreateThread(export_worker_main, "export", &workers[started]);
+        if (threads[started]) started++;
+        else ok = 0;
+    }
+
+    long written = -1;
+    if (ok) {
+        written = write_frames(&job, out);
+    } else if (started > 0) {
+        fail(&job); // stop whoever did start
+    }
+
+    for (int i = 0; i < started; ++i) SDL_WaitThread(threads[i], NULL);
+    if (fclose(out) != 0) written = -1; // flushes the last partial buffer
+    free(write_buffer);
+
+    if (job.ring){
+        for (int i = 0; i < job.ring_len; ++i) free(job.ring[i].bytes);
+    }
+    if (workers){
+        for (int i = 0; i < num_threads; ++i) free(workers[i].samples);
+    }
+    if (job.changed) SDL_DestroyCond(job.changed);
+    if (job.lock) SDL_DestroyMutex(job.lock);
+    free(job.path);
+    free(threads);
+    free(workers);
+    free(job.ring);
+    return written;
+}
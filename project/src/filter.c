@@ -0,0 +1,67 @@
+#include "filter.h"
+
+#include <math.h>
+#include <string.h>
+
+// all of the built in windows are functions of k / (K + 1), so weight only hits zero just past the last term
+double filter_weight(const FourierFilter *filter, int k, int K){
+    if (!filter) return 1.0;
+
+    double x = (double)k / (double)(K + 1);
+
+    switch (filter->kind){
+        case FILTER_GAUSSIAN:
+            return exp(-filter->strength * x * x);
+        case FILTER_LANCZOS: // sigma factors, sinc(x)
+            return x > 0.0 ? sin(M_PI * x) / (M_PI * x) : 1.0;
+        case FILTER_FEJER: // cesaro mean of the partial sums
+            return 1.0 - x;
+        case FILTER_CUSTOM:
+            return filter->kernel ? filter->kernel(k, K, filter->data) : 1.0;
+        case FILTER_NONE:
+        default:
+            return 1.0;
+    }
+}
+
+void filter_coeffs_1d(const FourierFilter *filter, int K, double *a, double *b){
+    if (!filter || filter->kind == FILTER_NONE) return;
+    for (int k = 1; k <= K; ++k){
+        double w = filter_weight(filter, k, K);
+        a[k-1] *= w;
+        b[k-1] *= w;
+    }
+}
+
+void filter_descriptors_2d(const FourierFilter *filter, int K, complex_t *descriptors){
+    if (!filter || filter->kind == FILTER_NONE) return;
+    for (int k = 1; k <= K; ++k){
+        double w = filter_weight(filter, k, K);
+        descriptors[K+k].re *= w;
+        descriptors[K+k].im *= w;
+        descriptors[K-k].re *= w;
+        descriptors[K-k].im *= w;
+    }
+}
+
+int filter_from_name(const char *name, FourierFilter *out){
+    out->kind = FILTER_NONE;
+    out->strength = FILTER_GAUSSIAN_STRENGTH;
+    out->kernel = NULL;
+    out->data = NULL;
+
+    if (strcmp(name, "none") == 0) return 1;
+    if (strcmp(name, "gaussian") == 0) {
+        out->kind = FILTER_GAUSSIAN;
+        return 1;
+    }
+    if (strcmp(name, "lanczos") == 0) {
+        out->kind = FILTER_LANCZOS;
+        return 1;
+    }
+    if (strcmp(name, "fejer") == 0) {
+        out->kind = FILTER_FEJER;
+        return 1;
+    }
+    return 0;
+}
@@ -1,10 +1,25 @@
 #include "fourier.h"
 
 #include "raster.h" // maybe not great from file structure perspective
+#include "elliptic.h"
+#include "filter.h"
+#include "planner.h"
+#include "timing.h"
 
 #define MIN_SAMPLE_DENSITY 128
 #define MAX_SAMPLE_DENSITY 4096
-#define CURVE_DENSITY 4
+#define CURVE_DENSITY 4 // upper bound on reconstruction samples per input sample
+#define MIN_CURVE_SAMPLES 64
+#define PIXEL_TOLERANCE 0.25 // max distance (in pixels) between curve and its chords
+
+void fourier_options_default(FourierOptions *opts){
+    opts->engine = FOURIER_ENGINE_DFT;
+    opts->filter.kind = FILTER_NONE;
+    opts->filter.strength = FILTER_GAUSSIAN_STRENGTH;
+    opts->filter.kernel = NULL;
+    opts->filter.data = NULL;
+    opts->snap_samples = 0;
+}
 
 // returns 0 if multiplication causes size_t overflow
 // otherwise returns 1 if you can safely multiply
@@ -139,7 +154,16 @@ void reconstruct_series(size_t N, int K, double a0, double *a, double *b, float
 }
 
 
-int fourier_1d(uint8_t *canvas, size_t width, size_t height, int num_terms){
+void fourier_prepare_plans(int dimension, int num_terms, const FourierOptions *opts){
+    if (dimension == 1){
+        planner_prepare(PLAN_1D, RASTER_SIZE, RASTER_SIZE, num_terms);
+    } else if (!opts || opts->engine == FOURIER_ENGINE_DFT){
+        // elliptic integrates the polyline directly, nothing to plan
+        planner_prepare(PLAN_2D, MIN_SAMPLE_DENSITY, MAX_SAMPLE_DENSITY, num_terms);
+    }
+}
+
+int fourier_1d(uint8_t *canvas, size_t width, size_t height, int num_terms, const FourierOptions *opts){
     if (!canvas || width == 0 || height == 0) return 0;
 
     // should be RASTER_SIZE ^2
@@ -178,7 +202,9 @@ int fourier_1d(uint8_t *canvas, size_t width, size_t height, int num_terms){
     }
 
     double a0 = 0.0;
-    dft_real_coeffs(input, width, K, &a0, a, b);
+    planned_real_coeffs(input, width, K, &a0, a, b);
+
+    if (opts) filter_coeffs_1d(&opts->filter, K, a, b);
 
     reconstruct_series(width, K, a0, a, b, output);
 
@@ -272,8 +298,6 @@ int uniform_pts_polyline(const Polyline *pl, Pt *output, size_t num_output){
     return 1;
 }
 
-typedef struct { double re, im; } complex_t;
-
 // WRITE OUT IN LATEX FOR CLARITY
 
 // compute 2d fourier descriptors (mostly based of second link found online)
@@ -328,19 +352,19 @@ void compute_fourier_descriptors(const Pt *input, size_t num_pts, int K, complex
     }
 }
 
-// hard to transcribe equations into code readably haha
-void reconstruct_series_2d(const complex_t *input, int K, size_t num_samples, Pt *output){
+// adds harmonics k_first..k_last to a reconstruction that's already partly summed
+// output must already hold the centroid (and any lower harmonics) - lets progressive display reuse earlier work
+void reconstruct_series_2d_band(const complex_t *input, int K, int k_first, int k_last, size_t num_samples, Pt *output){
     for (size_t r = 0; r < num_samples; ++r){
         // normalised around loop
         double t = (double)r / (double)num_samples; // nb have to cast here
 
-        // start at centroid
-        double x = input[K].re;
-        double y = input[K].im;
+        double x = output[r].x;
+        double y = output[r].y;
 
         double twopit = 2 * M_PI * t;
 
-        for (int k = 1; k <= K; ++k){
+        for (int k = k_first; k <= k_last; ++k){
 
             double theta = twopit * k;
             complex_t c_pos = input[K+k];
@@ -360,59 +384,222 @@ void reconstruct_series_2d(const complex_t *input, int K, size_t num_samples, Pt
     }
 }
 
+// hard to transcribe equations into code readably haha
+void reconstruct_series_2d(const complex_t *input, int K, size_t num_samples, Pt *output){
+    // start at centroid
+    for (size_t r = 0; r < num_samples; ++r){
+        output[r].x = input[K].re;
+        output[r].y = input[K].im;
+    }
+    reconstruct_series_2d_band(input, K, 1, K, num_samples, output);
+}
+
+// picks how many points to reconstruct from the descriptors
+// chord between two samples dt apart deviates from the curve by at most dt^2/8 * max|z''|
+// and |z''| <= (2pi)^2 * sum k^2 |c_k| for the truncated series, so solve for dt at PIXEL_TOLERANCE
+// also keeps at least 4 samples per period of the highest harmonic so small shapes still look round
+// result is clamped between MIN_CURVE_SAMPLES and max_samples
+size_t adaptive_num_samples(const complex_t *input, int K, size_t max_samples){
+    double curvature_bound = 0.0;
+    for (int k = 1; k <= K; ++k){
+        double mag_pos = hypot(input[K+k].re, input[K+k].im);
+        double mag_neg = hypot(input[K-k].re, input[K-k].im);
+        curvature_bound += (double)k * (double)k * (mag_pos + mag_neg);
+    }
+
+    double samples = 2.0 * M_PI * sqrt(curvature_bound / (8.0 * PIXEL_TOLERANCE));
+    if (!isfinite(samples)) samples = (double)max_samples;
+    if (samples < 4.0 * K) samples = 4.0 * K;
+
+    size_t num_samples = (size_t)ceil(samples);
+    if (num_samples < MIN_CURVE_SAMPLES) num_samples = MIN_CURVE_SAMPLES;
+    if (num_samples > max_samples) num_samples = max_samples;
+    return num_samples;
+}
+
+void fourier_2d_progress_init(Fourier2DProgress *fp){
+    fp->spaced_pts = NULL;
+    fp->num_pts = 0;
+    fp->descriptors = NULL;
+    fp->K = 0;
+    fp->k_done = 0;
+    fp->partial = NULL;
+    fp->num_samples = 0;
+}
+
+void fourier_2d_progress_free(Fourier2DProgress *fp){
+    free(fp->spaced_pts);
+    free(fp->descriptors);
+    free(fp->partial);
+    fourier_2d_progress_init(fp);
+}
+
+// elliptic engine works on the raw vertices, so those are what gets drawn as the original
+// returns 0 on malloc failure or degenerate input
+static int elliptic_start(const Polyline *pl, int K, Pt **pts_out, complex_t **descriptors_out){
+    Pt *pts = malloc(sizeof(Pt) * pl->len);
+    complex_t *descriptors = calloc(2*K+1, sizeof(complex_t));
+    if (!pts || !descriptors || !elliptic_descriptors(pl, K, descriptors)){
+        free(pts);
+        free(descriptors);
+        return 0;
+    }
+    for (size_t i = 0; i < pl->len; ++i){
+        pts[i].x = pl->pts[i].x;
+        pts[i].y = pl->pts[i].y;
+    }
+    *pts_out = pts;
+    *descriptors_out = descriptors;
+    return 1;
+}
+
 //better to do it from polyline in this case I think
-int fourier_2d_from_pl(uint8_t *canvas, size_t width, size_t height, int num_terms, const Polyline *pl) {
+int fourier_2d_progress_start(Fourier2DProgress *fp, int num_terms, const Polyline *pl, const FourierOptions *opts){
+    fourier_2d_progress_free(fp);
+
+    FourierOptions defaults;
+    if (!opts) {
+        fourier_options_default(&defaults);
+        opts = &defaults;
+    }
+
     // general safety checks
-    if (!canvas || !pl || !pl->pts || pl->len < 2 || width == 0 || height == 0) return 0;
+    if (!pl || !pl->pts || pl->len < 2) return 0;
 
     size_t num_pts = pl->len;
     if (num_pts < MIN_SAMPLE_DENSITY) num_pts = MIN_SAMPLE_DENSITY;
     if (num_pts > MAX_SAMPLE_DENSITY) num_pts = MAX_SAMPLE_DENSITY;
+    if (opts->snap_samples && opts->engine == FOURIER_ENGINE_DFT) num_pts = fft_specialized_size(num_pts);
 
-    Pt *spaced_pts = malloc(sizeof(Pt)*num_pts);
-    if(!spaced_pts) return 0;
+    // reconstruction cap is the same for both engines so they're comparable
+    size_t max_samples = num_pts * CURVE_DENSITY;
 
-    // resamples uniformly (stored in spaced_pts)
-    if (!uniform_pts_polyline(pl, spaced_pts, num_pts)){
-        free(spaced_pts);
-        return 0;
-    }
+    Pt *spaced_pts = NULL;
+    complex_t *descriptors = NULL;
+    int K = num_terms;
 
-    // snap last sample to first to avoid gaps
-    spaced_pts[num_pts-1].x = spaced_pts[0].x;
-    spaced_pts[num_pts-1].y = spaced_pts[0].y;
+    if (opts->engine == FOURIER_ENGINE_ELLIPTIC) {
+        // exact integral, so no nyquist limit on K
+        if (!elliptic_start(pl, K, &spaced_pts, &descriptors)) return 0;
+        num_pts = pl->len;
+    } else {
+        spaced_pts = malloc(sizeof(Pt)*num_pts);
+        if(!spaced_pts) return 0;
 
-    int K = num_terms;
-    if (K > (num_pts / 2 - 1)) K = num_pts / 2 - 1;
+        // resamples uniformly (stored in spaced_pts)
+        if (!uniform_pts_polyline(pl, spaced_pts, num_pts)){
+            free(spaced_pts);
+            return 0;
+        }
 
-    // initialise complex array for descriptors (as output)
-    complex_t *descriptors = calloc(2*K+1, sizeof(complex_t));
-    if (!descriptors) {
-        free(spaced_pts);
-        return 0;
+        // snap last sample to first to avoid gaps
+        spaced_pts[num_pts-1].x = spaced_pts[0].x;
+        spaced_pts[num_pts-1].y = spaced_pts[0].y;
+
+        if (K > (num_pts / 2 - 1)) K = num_pts / 2 - 1;
+
+        // initialise complex array for descriptors (as output)
+        descriptors = calloc(2*K+1, sizeof(complex_t));
+        if (!descriptors) {
+            free(spaced_pts);
+            return 0;
+        }
+
+        planned_descriptors(spaced_pts, num_pts, K, descriptors);
     }
 
-    compute_fourier_descriptors(spaced_pts, num_pts, K, descriptors);
+    // smoothing lowers the curvature bound too, so fewer samples below
+    filter_descriptors_2d(&opts->filter, K, descriptors);
 
-    size_t num_samples = num_pts * CURVE_DENSITY;
+    // cost now follows the shape's complexity rather than the input length
+    size_t num_samples = adaptive_num_samples(descriptors, K, max_samples);
 
-    Pt *reconstructed = malloc(sizeof(Pt) * num_samples);
-    if(!reconstructed){
+    Pt *partial = malloc(sizeof(Pt) * num_samples);
+    if(!partial){
         free(spaced_pts);
         free(descriptors);
         return 0;
     }
 
+    // level zero is just the centroid
+    for (size_t r = 0; r < num_samples; ++r){
+        partial[r].x = descriptors[K].re;
+        partial[r].y = descriptors[K].im;
+    }
+
+    fp->spaced_pts = spaced_pts;
+    fp->num_pts = num_pts;
+    fp->descriptors = descriptors;
+    fp->K = K;
+    fp->k_done = 0;
+    fp->partial = partial;
+    fp->num_samples = num_samples;
+    return 1;
+}
+
+int fourier_2d_progress_done(const Fourier2DProgress *fp){
+    return fp->partial && fp->k_done >= fp->K;
+}
+
+int fourier_2d_progress_step(Fourier2DProgress *fp, uint8_t *canvas, double budget_ms){
+    if (!fp->partial || !canvas) return 0;
+
+    double start = now_ms();
+    double per_band = 0.0; // cost of the slowest band so far
+
+    // always adds at least one harmonic so something new shows every call
+    while (fp->k_done < fp->K){
+        double band_start = now_ms();
+        int k = fp->k_done + 1;
+        reconstruct_series_2d_band(fp->descriptors, fp->K, k, k, fp->num_samples, fp->partial);
+        fp->k_done = k;
+
+        double now = now_ms();
+        if (now - band_start > per_band) per_band = now - band_start;
+        if (now - start + per_band > budget_ms) break; // next band wouldn't fit
+    }
+
+    raster_clear(canvas);
+
+    raster_closed_line_from_pts(canvas, fp->spaced_pts, fp->num_pts, 2);
+    raster_closed_line_from_pts(canvas, fp->partial, fp->num_samples, 1);
+
+    return 1;
+}
+
+// for shapes whose descriptors came from somewhere else (eg svg import)
+int fourier_2d_from_descriptors(uint8_t *canvas, const complex_t *descriptors, int K, const Pt *outline, size_t num_outline){
+    if (!canvas || !descriptors || K < 0) return 0;
+
+    size_t num_samples = adaptive_num_samples(descriptors, K, MAX_SAMPLE_DENSITY * CURVE_DENSITY);
+
+    Pt *reconstructed = malloc(sizeof(Pt) * num_samples);
+    if (!reconstructed) return 0;
+
     reconstruct_series_2d(descriptors, K, num_samples, reconstructed);
 
     raster_clear(canvas);
 
-    raster_closed_line_from_pts(canvas, spaced_pts, num_pts, 2);
+    if (outline) raster_closed_line_from_pts(canvas, outline, num_outline, 2);
     raster_closed_line_from_pts(canvas, reconstructed, num_samples, 1);
 
-    free(spaced_pts);
-    free(descriptors);
     free(reconstructed);
     return 1;
+}
+
+int fourier_2d_from_pl(uint8_t *canvas, size_t width, size_t height, int num_terms, const Polyline *pl, const FourierOptions *opts) {
+    // general safety checks
+    if (!canvas || !pl || !pl->pts || pl->len < 2 || width == 0 || height == 0) return 0;
+
+    Fourier2DProgress fp;
+    fourier_2d_progress_init(&fp);
 
-}
\ No newline at end of file
+    if (!fourier_2d_progress_start(&fp, num_terms, pl, opts)) return 0;
+
+    // no budget - adds every band in one go
+    fourier_2d_progress_step(&fp, canvas, HUGE_VAL);
+
+    fourier_2d_progress_free(&fp);
+    return 1;
+
+}
@@ -2,6 +2,7 @@
 #include "draw_input.h" // this might not be great
 
 #include <stdlib.h> // necessary?
+#include <string.h>
 #include <math.h>
 
 #define START_CAP 128
@@ -117,3 +118,80 @@ void polyline_clear(Polyline *pl){
 int polyline_empty(Polyline *pl){
     return pl->len == 0;
 }
+
+void point_store_init(PointStore *ps){
+    ps->chunks = NULL;
+    ps->num_chunks = 0;
+    ps->chunk_cap = 0;
+    ps->free_list = NULL;
+    ps->len = 0;
+}
+
+void point_store_free(PointStore *ps){
+    point_store_clear(ps); // everything onto the free list first
+    while (ps->free_list){
+        PointChunk *next = ps->free_list->next;
+        free(ps->free_list);
+        ps->free_list = next;
+    }
+    free(ps->chunks);
+    point_store_init(ps);
+}
+
+void point_store_clear(PointStore *ps){
+    for (size_t i = 0; i < ps->num_chunks; ++i){
+        ps->chunks[i]->next = ps->free_list;
+        ps->free_list = ps->chunks[i];
+    }
+    ps->num_chunks = 0;
+    ps->len = 0;
+}
+
+int point_store_push(PointStore *ps, Vec2 p){
+    size_t offset = ps->len & (POINT_CHUNK_SIZE - 1);
+
+    if (offset == 0 && (ps->len >> POINT_CHUNK_SHIFT) == ps->num_chunks){
+        // chunk table only holds pointers, so growing it is cheap and rare
+        if (ps->num_chunks == ps->chunk_cap){
+            size_t new_cap = ps->chunk_cap ? 2 * ps->chunk_cap : 16;
+            void *table = realloc(ps->chunks, new_cap * sizeof(PointChunk *));
+            if (!table) return 0;
+            ps->chunks = (PointChunk **)table;
+            ps->chunk_cap = new_cap;
+        }
+
+        PointChunk *chunk = ps->free_list;
+        if (chunk){
+            ps->free_list = chunk->next;
+        } else {
+            chunk = malloc(sizeof(PointChunk));
+            if (!chunk) return 0;
+        }
+        ps->chunks[ps->num_chunks++] = chunk;
+    }
+
+    ps->chunks[ps->len >> POINT_CHUNK_SHIFT]->pts[offset] = p;
+    ps->len++;
+    return 1;
+}
+
+Vec2 point_store_get(const PointStore *ps, size_t i){
+    return ps->chunks[i >> POINT_CHUNK_SHIFT]->pts[i & (POINT_CHUNK_SIZE - 1)];
+}
+
+int point_store_view(const PointStore *ps, Polyline *pl){
+    if (pl->len > ps->len) pl->len = 0; // store was cleared behind our back - start over
+    if (ps->len > pl->cap && !polyline_reserve(pl, ps->len)) return 0;
+
+    // whole chunks at a time
+    size_t i = pl->len;
+    while (i < ps->len){
+        size_t offset = i & (POINT_CHUNK_SIZE - 1);
+        size_t count = POINT_CHUNK_SIZE - offset;
+        if (count > ps->len - i) count = ps->len - i;
+        memcpy(pl->pts + i, ps->chunks[i >> POINT_CHUNK_SHIFT]->pts + offset, count * sizeof(Vec2));
+        i += count;
+    }
+    pl->len = ps->len;
+    return 1;
+}
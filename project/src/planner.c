@@ -0,0 +1,234 @@
+#include "planner.h"
+#include "timing.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <math.h>
+
+#define PLANNER_SLOTS 256 // buckets are log2 sizes, so this is far more than ever get used
+#define PLANNER_REPS 3 // timings per candidate, fastest one counts
+
+typedef struct {
+    int used;
+    int kind;
+    int n_bucket; // ceil(log2 N)
+    int k_bucket; // ceil(log2 K)
+    DftAlgo best;
+    DftAlgo best_no_fft; // for sizes in the bucket that aren't powers of two
+} PlanEntry;
+
+// shared by the compute thread and anything headless, so guarded by a spinlock (only held for lookups)
+// plain C11 flag rather than SDL's so the maths side stays free of SDL
+static PlanEntry plans[PLANNER_SLOTS];
+static atomic_flag plans_lock = ATOMIC_FLAG_INIT;
+
+static void plans_acquire(void){
+    while (atomic_flag_test_and_set_explicit(&plans_lock, memory_order_acquire));
+}
+
+static void plans_release(void){
+    atomic_flag_clear_explicit(&plans_lock, memory_order_release);
+}
+
+static int ceil_log2(size_t n){
+    int b = 0;
+    while (((size_t)1 << b) < n) b++;
+    return b;
+}
+
+// caller holds the lock
+static PlanEntry *find_slot(int kind, int n_bucket, int k_bucket, int create){
+    unsigned int h = (unsigned int)(kind * 131 + n_bucket * 31 + k_bucket) % PLANNER_SLOTS;
+    for (int probe = 0; probe < PLANNER_SLOTS; ++probe){
+        PlanEntry *e = &plans[(h + probe) % PLANNER_SLOTS];
+        if (!e->used){
+            if (!create) return NULL;
+            e->used = 1;
+            e->kind = kind;
+            e->n_bucket = n_bucket;
+            e->k_bucket = k_bucket;
+            return e;
+        }
+        if (e->kind == kind && e->n_bucket == n_bucket && e->k_bucket == k_bucket) return e;
+    }
+    return NULL; // full, just won't cache
+}
+
+// runs one kernel on the bucket's representative size, returns ms (HUGE_VAL if it can't run)
+static double time_algo(PlanKind kind, DftAlgo algo, size_t N, int K, const float *f, const Pt *pts, double *a, double *b, complex_t *desc){
+    double best = HUGE_VAL;
+    for (int rep = 0; rep < PLANNER_REPS; ++rep){
+        double start = now_ms();
+        double a0;
+        int ok = 1;
+        if (kind == PLAN_1D){
+            if (algo == DFT_DIRECT) dft_real_coeffs(f, N, K, &a0, a, b);
+            else if (algo == DFT_GOERTZEL) dft_real_coeffs_goertzel(f, N, K, &a0, a, b);
+            else ok = dft_real_coeffs_fft(f, N, K, &a0, a, b);
+        } else {
+            if (algo == DFT_DIRECT) compute_fourier_descriptors(pts, N, K, desc);
+            else if (algo == DFT_GOERTZEL) compute_fourier_descriptors_goertzel(pts, N, K, desc);
+            else ok = compute_fourier_descriptors_fft(pts, N, K, desc);
+        }
+        if (!ok) return HUGE_VAL;
+        double elapsed = now_ms() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// times every candidate at N = 2^n_bucket, K = 2^k_bucket (capped so the 2D transform is valid)
+static void benchmark_bucket(PlanKind kind, int n_bucket, int k_bucket, DftAlgo *best_out, DftAlgo *best_no_fft_out){
+    size_t N = (size_t)1 << n_bucket;
+    int K = 1 << k_bucket;
+    if ((size_t)K > N / 2 - 1) K = (int)(N / 2 - 1);
+    if (K < 1) K = 1;
+
+    float *f = malloc(sizeof(float) * N);
+    Pt *pts = malloc(sizeof(Pt) * N);
+    double *a = malloc(sizeof(double) * 2 * (size_t)K);
+    complex_t *desc = malloc(sizeof(complex_t) * (2 * (size_t)K + 1));
+
+    *best_out = DFT_DIRECT;
+    *best_no_fft_out = DFT_DIRECT;
+    if (!f || !pts || !a || !desc){
+        free(f); free(pts); free(a); free(desc);
+        return;
+    }
+
+    // any smooth loop will do, only the timing matters
+    for (size_t n = 0; n < N; ++n){
+        double t = 2.0 * M_PI * (double)n / (double)N;
+        f[n] = (float)(256.0 + 100.0 * sin(3.0 * t));
+        pts[n].x = 256.0 + 100.0 * cos(t);
+        pts[n].y = 256.0 + 80.0 * sin(t) + 10.0 * sin(5.0 * t);
+    }
+
+    double best_time = HUGE_VAL;
+    double best_no_fft_time = HUGE_VAL;
+    for (int algo = 0; algo < DFT_NUM_ALGOS; ++algo){
+        double ms = time_algo(kind, (DftAlgo)algo, N, K, f, pts, a, a + K, desc);
+        if (ms < best_time){
+            best_time = ms;
+            *best_out = (DftAlgo)algo;
+        }
+        if (algo != DFT_FFT && ms < best_no_fft_time){
+            best_no_fft_time = ms;
+            *best_no_fft_out = (DftAlgo)algo;
+        }
+    }
+
+    free(f); free(pts); free(a); free(desc);
+}
+
+// cached answer for a bucket, timing it first if nothing has been seen for it yet
+static void plan_bucket(PlanKind kind, int n_bucket, int k_bucket, DftAlgo *best_out, DftAlgo *best_no_fft_out){
+    plans_acquire();
+    PlanEntry *e = find_slot(kind, n_bucket, k_bucket, 0);
+    if (e){
+        *best_out = e->best;
+        *best_no_fft_out = e->best_no_fft;
+        plans_release();
+        return;
+    }
+    plans_release();
+
+    // timed without the lock, two threads racing on the same bucket just both measure it
+    benchmark_bucket(kind, n_bucket, k_bucket, best_out, best_no_fft_out);
+
+    plans_acquire();
+    e = find_slot(kind, n_bucket, k_bucket, 1);
+    if (e){
+        e->best = *best_out;
+        e->best_no_fft = *best_no_fft_out;
+    }
+    plans_release();
+}
+
+void planner_prepare(PlanKind kind, size_t N_min, size_t N_max, int K_max){
+    int k_top = ceil_log2(K_max > 0 ? (size_t)K_max : 1);
+    for (int n_bucket = ceil_log2(N_min); n_bucket <= ceil_log2(N_max); ++n_bucket){
+        for (int k_bucket = 0; k_bucket <= k_top; ++k_bucket){
+            DftAlgo best, best_no_fft;
+            plan_bucket(kind, n_bucket, k_bucket, &best, &best_no_fft);
+        }
+    }
+}
+
+DftAlgo planner_choose(PlanKind kind, size_t N, int K){
+    DftAlgo best, best_no_fft;
+    plan_bucket(kind, ceil_log2(N), ceil_log2(K > 0 ? (size_t)K : 1), &best, &best_no_fft);
+    return is_power_of_two(N) ? best : best_no_fft;
+}
+
+void planned_real_coeffs(const float *f, size_t N, int K, double *a0_out, double *a, double *b){
+    switch (planner_choose(PLAN_1D, N, K)){
+        case DFT_GOERTZEL:
+            dft_real_coeffs_goertzel(f, N, K, a0_out, a, b);
+            return;
+        case DFT_FFT:
+            if (dft_real_coeffs_fft(f, N, K, a0_out, a, b)) return;
+            break;
+        default:
+            break;
+    }
+    dft_real_coeffs(f, N, K, a0_out, a, b);
+}
+
+void planned_descriptors(const Pt *input, size_t num_pts, int K, complex_t *output){
+    switch (planner_choose(PLAN_2D, num_pts, K)){
+        case DFT_GOERTZEL:
+            compute_fourier_descriptors_goertzel(input, num_pts, K, output);
+            return;
+        case DFT_FFT:
+            if (compute_fourier_descriptors_fft(input, num_pts, K, output)) return;
+            break;
+        default:
+            break;
+    }
+    compute_fourier_descriptors(input, num_pts, K, output);
+}
+
+int planner_load_wisdom(const char *filename){
+    FILE *f = fopen(filename, "r");
+    if (!f) return 0;
+
+    int loaded = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), f)){
+        if (line[0] == '#') continue;
+        int kind, n_bucket, k_bucket, best, best_no_fft;
+        if (sscanf(line, "%d %d %d %d %d", &kind, &n_bucket, &k_bucket, &best, &best_no_fft) != 5) continue;
+        if (kind < PLAN_1D || kind > PLAN_2D || best < 0 || best >= DFT_NUM_ALGOS
+            || best_no_fft < 0 || best_no_fft >= DFT_NUM_ALGOS || best_no_fft == DFT_FFT) continue;
+
+        plans_acquire();
+        PlanEntry *e = find_slot(kind, n_bucket, k_bucket, 1);
+        if (e){
+            e->best = (DftAlgo)best;
+            e->best_no_fft = (DftAlgo)best_no_fft;
+            loaded++;
+        }
+        plans_release();
+    }
+    fclose(f);
+    return loaded;
+}
+
+int planner_save_wisdom(const char *filename){
+    FILE *f = fopen(filename, "w");
+    if (!f) return 0;
+
+    fprintf(f, "# fourier planner wisdom: kind n_bucket k_bucket best best_without_fft\n");
+    fprintf(f, "# kind 0 = 1D, 1 = 2D; buckets are ceil(log2); algos 0 = direct, 1 = goertzel, 2 = fft\n");
+
+    plans_acquire();
+    for (int i = 0; i < PLANNER_SLOTS; ++i){
+        if (!plans[i].used) continue;
+        fprintf(f, "%d %d %d %d %d\n", plans[i].kind, plans[i].n_bucket, plans[i].k_bucket,
+            (int)plans[i].best, (int)plans[i].best_no_fft);
+    }
+    plans_release();
+
+    return fclose(f) == 0;
+}
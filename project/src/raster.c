@@ -5,6 +5,9 @@
 #include <math.h>
 #include <string.h>
 
+#define CIRCLE_STEPS_MIN 12
+#define CIRCLE_STEPS_MAX 96
+
 
 // basic implementation of Bresenham line algorithm found online (https://gist.github.com/bert/1085538)
 // rasterises line and sets pixels to val
@@ -77,6 +80,29 @@ void raster_closed_line_from_pts(uint8_t *img, const Pt *pts, size_t n, uint8_t
     }
 }
 
+void raster_open_line_from_pts(uint8_t *img, const Pt *pts, size_t n, uint8_t val){
+    if (!img || !pts || n < 2) return;
 
+    for (size_t i = 1; i < n; ++i){
+        raster_line(img, (int)lround(pts[i-1].x), (int)lround(pts[i-1].y),
+            (int)lround(pts[i].x), (int)lround(pts[i].y), val);
+    }
+}
 
-
+// polygon approximation, more sides for bigger circles
+void raster_circle(uint8_t *img, double cx, double cy, double radius, uint8_t val){
+    int steps = (int)(radius * 0.5); // roughly a 12px chord
+    if (steps < CIRCLE_STEPS_MIN) steps = CIRCLE_STEPS_MIN;
+    if (steps > CIRCLE_STEPS_MAX) steps = CIRCLE_STEPS_MAX;
+
+    int x_prev = (int)lround(cx + radius);
+    int y_prev = (int)lround(cy);
+    for (int i = 1; i <= steps; ++i){
+        double angle = 2.0 * M_PI * (double)i / (double)steps;
+        int x = (int)lround(cx + radius * cos(angle));
+        int y = (int)lround(cy + radius * sin(angle));
+        raster_line(img, x_prev, y_prev, x, y, val);
+        x_prev = x;
+        y_prev = y;
+    }
+}
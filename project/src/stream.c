@@ -0,0 +1,252 @@
+#include "stream.h"
+#include "filter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define READ_BLOCK 65536
+#define MAX_TOKEN 64 // longest number we accept
+
+// --- buffered number reader ---
+// pulls big blocks with fread and parses in place, so the numbers aren't the bottleneck
+
+typedef struct {
+    FILE *f;
+    char buf[READ_BLOCK + 1];
+    size_t pos;
+    size_t len;
+    int eof;
+} SampleReader;
+
+static void reader_fill(SampleReader *r){
+    // keep any partial token at the front
+    memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+    r->len -= r->pos;
+    r->pos = 0;
+    size_t got = fread(r->buf + r->len, 1, READ_BLOCK - r->len, r->f);
+    if (got == 0) r->eof = 1;
+    r->len += got;
+    r->buf[r->len] = '\0';
+}
+
+// returns 1 with a sample, 0 at end of input, -1 on junk
+static int reader_next(SampleReader *r, double *out){
+    while (1){
+        while (r->pos < r->len && (isspace((unsigned char)r->buf[r->pos]) || r->buf[r->pos] == ',')) r->pos++;
+        if (r->pos == r->len){
+            if (r->eof) return 0;
+            reader_fill(r);
+            continue;
+        }
+
+        // make sure the whole token is in the buffer before parsing it
+        size_t end = r->pos;
+        while (end < r->len && !isspace((unsigned char)r->buf[end]) && r->buf[end] != ',') end++;
+        if (end == r->len && !r->eof && end - r->pos < MAX_TOKEN){
+            reader_fill(r);
+            continue;
+        }
+
+        char *stop = NULL;
+        double v = strtod(r->buf + r->pos, &stop);
+        if (stop == r->buf + r->pos) return -1;
+        r->pos = (size_t)(stop - r->buf);
+        *out = v;
+        return 1;
+    }
+}
+
+// --- plan ---
+
+int stream_plan_init(StreamPlan *sp, size_t window, int K){
+    sp->hann = NULL;
+    sp->cos_table = NULL;
+    sp->sin_table = NULL;
+    if (window < 4 || window % 2 != 0 || K < 1 || (size_t)K >= window / 2) return 0;
+
+    sp->window = window;
+    sp->hop = window / 2;
+    sp->K = K;
+
+    sp->hann = malloc(sizeof(double) * window);
+    sp->cos_table = malloc(sizeof(double) * window * (size_t)K);
+    sp->sin_table = malloc(sizeof(double) * window * (size_t)K);
+    if (!sp->hann || !sp->cos_table || !sp->sin_table){
+        stream_plan_free(sp);
+        return 0;
+    }
+
+    // periodic hann - copies shifted by window / 2 add up to exactly 1
+    for (size_t n = 0; n < window; ++n){
+        sp->hann[n] = 0.5 - 0.5 * cos(2.0 * M_PI * (double)n / (double)window);
+    }
+
+    for (int k = 1; k <= K; ++k){
+        double *c = sp->cos_table + (size_t)(k-1) * window;
+        double *s = sp->sin_table + (size_t)(k-1) * window;
+        for (size_t n = 0; n < window; ++n){
+            double arg = 2.0 * M_PI * (double)k * (double)n / (double)window;
+            c[n] = cos(arg);
+            s[n] = sin(arg);
+        }
+    }
+    return 1;
+}
+
+void stream_plan_free(StreamPlan *sp){
+    free(sp->hann);
+    free(sp->cos_table);
+    free(sp->sin_table);
+    sp->hann = NULL;
+    sp->cos_table = NULL;
+    sp->sin_table = NULL;
+}
+
+// --- transform ---
+
+// per stream buffers - this is all the memory a stream ever uses
+typedef struct {
+    const StreamPlan *sp;
+    StreamOutput mode;
+    const FourierFilter *filter;
+    FILE *out;
+    double *frame; // last window of samples
+    double *windowed;
+    double *overlap; // overlap-add accumulator
+    double *a;
+    double *b;
+    long windows;
+    unsigned long long total_in;
+    unsigned long long total_out;
+} StreamState;
+
+// same sums as dft_real_coeffs, on the windowed frame and with the plan's tables
+static void window_coeffs(const StreamPlan *sp, const double *frame, double *windowed, double *a0_out, double *a, double *b){
+    size_t N = sp->window;
+    double a0 = 0.0;
+    for (size_t n = 0; n < N; ++n){
+        windowed[n] = frame[n] * sp->hann[n];
+        a0 += windowed[n];
+    }
+    *a0_out = a0 / (double)N;
+
+    const double scale = 2.0 / (double)N;
+    for (int k = 1; k <= sp->K; ++k){
+        const double *c = sp->cos_table + (size_t)(k-1) * N;
+        const double *s = sp->sin_table + (size_t)(k-1) * N;
+        double ak = 0.0;
+        double bk = 0.0;
+        for (size_t n = 0; n < N; ++n){
+            ak += windowed[n] * c[n];
+            bk += windowed[n] * s[n];
+        }
+        a[k-1] = scale * ak;
+        b[k-1] = scale * bk;
+    }
+}
+
+// transforms the current frame, writes whatever output is now final, then slides everything by a hop
+static void stream_window(StreamState *st){
+    const StreamPlan *sp = st->sp;
+    size_t N = sp->window;
+    size_t H = sp->hop;
+    int K = sp->K;
+
+    double a0;
+    window_coeffs(sp, st->frame, st->windowed, &a0, st->a, st->b);
+    if (st->filter) filter_coeffs_1d(st->filter, K, st->a, st->b);
+
+    if (st->mode == STREAM_OUTPUT_COEFFS){
+        // undo hann's 0.5 gain so amplitudes read like the signal
+        long long first = (long long)st->windows * (long long)H - (long long)H;
+        fprintf(st->out, "%ld %lld %.9g", st->windows, first, 2.0 * a0);
+        for (int k = 0; k < K; ++k) fprintf(st->out, " %.9g %.9g", 2.0 * st->a[k], 2.0 * st->b[k]);
+        fputc('\n', st->out);
+    } else {
+        for (size_t n = 0; n < N; ++n){
+            double y = a0;
+            for (int k = 1; k <= K; ++k){
+                y += st->a[k-1] * sp->cos_table[(size_t)(k-1) * N + n] + st->b[k-1] * sp->sin_table[(size_t)(k-1) * N + n];
+            }
+            st->overlap[n] += y;
+        }
+
+        // first half now has both windows in it - window 0's first half was padding though
+        if (st->windows > 0){
+            for (size_t n = 0; n < H && st->total_out < st->total_in; ++n){
+                fprintf(st->out, "%.9g\n", st->overlap[n]);
+                st->total_out++;
+            }
+        }
+        memmove(st->overlap, st->overlap + H, sizeof(double) * (N - H));
+        memset(st->overlap + N - H, 0, sizeof(double) * H);
+    }
+
+    memmove(st->frame, st->frame + H, sizeof(double) * (N - H));
+    st->windows++;
+}
+
+long stream_1d(FILE *in, FILE *out, const StreamPlan *sp, StreamOutput mode, const FourierFilter *filter){
+    size_t N = sp->window;
+    size_t H = sp->hop;
+    int K = sp->K;
+
+    double *work = calloc(3 * N + 2 * (size_t)K, sizeof(double));
+    SampleReader *reader = malloc(sizeof(SampleReader));
+    if (!work || !reader){
+        free(work);
+        free(reader);
+        return -1;
+    }
+
+    StreamState st;
+    st.sp = sp;
+    st.mode = mode;
+    st.filter = filter;
+    st.out = out;
+    st.frame = work; // first window begins H samples before the signal
+    st.windowed = st.frame + N;
+    st.overlap = st.windowed + N;
+    st.a = st.overlap + N;
+    st.b = st.a + K;
+    st.windows = 0;
+    st.total_in = 0;
+    st.total_out = 0;
+
+    reader->f = in;
+    reader->pos = 0;
+    reader->len = 0;
+    reader->eof = 0;
+
+    size_t have = 0; // new samples in the current hop
+    int status;
+    double v = 0.0;
+    while ((status = reader_next(reader, &v)) == 1){
+        // padding repeats the edge samples - zeros would put a step at each end and ring
+        if (st.total_in == 0){
+            for (size_t n = 0; n < N - H; ++n) st.frame[n] = v;
+        }
+        st.frame[N - H + have++] = v;
+        st.total_in++;
+        if (have == H){
+            stream_window(&st);
+            have = 0;
+        }
+    }
+
+    // two more windows finish off the last samples' overlap - empty input has nothing to finish
+    if (status == 0 && st.total_in > 0){
+        for (int flush = 0; flush < 2; ++flush){
+            while (have < H) st.frame[N - H + have++] = v; // last sample
+            stream_window(&st);
+            have = 0;
+        }
+    }
+
+    free(work);
+    free(reader);
+    fflush(out);
+    return status < 0 ? -1 : st.windows;
+}
@@ -0,0 +1,76 @@
+#include "stroke_layer.h"
+
+static void clear_background(SDL_Renderer *ren){
+    SDL_SetRenderDrawColor(ren, 128, 128, 128, 255); // background colour - light gray
+    SDL_RenderClear(ren);
+}
+
+// segments between points first and last (inclusive) of the store, in as few calls as the batch allows
+static void draw_range(StrokeLayer *sl, SDL_Renderer *ren, const PointStore *ps, size_t first, size_t last){
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 255); // line colour - black
+    size_t i = first;
+    while (i < last){
+        int count = 0;
+        while (count < STROKE_BATCH && i + count <= last){
+            Vec2 p = point_store_get(ps, i + count);
+            sl->batch[count].x = (int)p.x;
+            sl->batch[count].y = (int)p.y;
+            count++;
+        }
+        SDL_RenderDrawLines(ren, sl->batch, count);
+        i += count - 1; // next batch starts on this one's last point so the line stays joined
+    }
+}
+
+int stroke_layer_init(StrokeLayer *sl, SDL_Renderer *ren, int width, int height){
+    sl->width = width;
+    sl->height = height;
+    sl->drawn = 0;
+    sl->strokes = 0;
+    sl->dirty = 1;
+    sl->target = NULL;
+
+    if (!SDL_RenderTargetSupported(ren)) return 0;
+    sl->target = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    return sl->target != NULL;
+}
+
+void stroke_layer_free(StrokeLayer *sl){
+    if (sl->target) SDL_DestroyTexture(sl->target);
+    sl->target = NULL;
+}
+
+void stroke_layer_invalidate(StrokeLayer *sl){
+    sl->dirty = 1;
+}
+
+void stroke_layer_render(StrokeLayer *sl, SDL_Renderer *ren, const DrawInput *di){
+    const PointStore *ps = &di->store;
+
+    if (!sl->target){
+        clear_background(ren);
+        if (ps->len >= 2) draw_range(sl, ren, ps, 0, ps->len - 1);
+        return;
+    }
+
+    // new stroke since last frame (or the store shrank some other way) - start the texture over
+    if (di->strokes != sl->strokes || ps->len < sl->drawn){
+        sl->strokes = di->strokes;
+        sl->dirty = 1;
+    }
+
+    SDL_SetRenderTarget(ren, sl->target);
+    if (sl->dirty){
+        clear_background(ren);
+        sl->drawn = 0;
+        sl->dirty = 0;
+    }
+    if (ps->len >= 2 && ps->len > sl->drawn){
+        size_t first = sl->drawn ? sl->drawn - 1 : 0; // joins onto the last point already drawn
+        draw_range(sl, ren, ps, first, ps->len - 1);
+    }
+    sl->drawn = ps->len;
+    SDL_SetRenderTarget(ren, NULL);
+
+    SDL_RenderCopy(ren, sl->target, NULL, NULL);
+}
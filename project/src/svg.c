@@ -0,0 +1,427 @@
+#include "svg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define START_SEGS 64
+#define SERIES_TERMS 25 // plenty for |s| < 1, last term is below 1e-25
+
+// small complex helpers - complex_t is just a pair of doubles
+static complex_t c_make(double re, double im){ complex_t c = {re, im}; return c; }
+static complex_t c_add(complex_t a, complex_t b){ return c_make(a.re + b.re, a.im + b.im); }
+static complex_t c_sub(complex_t a, complex_t b){ return c_make(a.re - b.re, a.im - b.im); }
+static complex_t c_scale(complex_t a, double s){ return c_make(a.re * s, a.im * s); }
+static complex_t c_mul(complex_t a, complex_t b){
+    return c_make(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+static complex_t c_div(complex_t a, complex_t b){
+    double denom = b.re * b.re + b.im * b.im;
+    return c_make((a.re * b.re + a.im * b.im) / denom, (a.im * b.re - a.re * b.im) / denom);
+}
+static complex_t c_exp(complex_t a){
+    double mag = exp(a.re);
+    return c_make(mag * cos(a.im), mag * sin(a.im));
+}
+
+void shape_init(Shape *s){
+    s->segs = NULL;
+    s->len = 0;
+    s->cap = 0;
+}
+
+void shape_free(Shape *s){
+    free(s->segs);
+    shape_init(s);
+}
+
+// returns 0 on malloc failure
+static int shape_push(Shape *s, PathSegment seg){
+    if (s->len == s->cap){
+        size_t new_cap = s->cap ? 2 * s->cap : START_SEGS;
+        void *p = realloc(s->segs, new_cap * sizeof(PathSegment));
+        if (!p) return 0;
+        s->segs = (PathSegment *)p;
+        s->cap = new_cap;
+    }
+    s->segs[s->len++] = seg;
+    return 1;
+}
+
+static Pt segment_end(const PathSegment *seg){
+    return seg->p[seg->type];
+}
+
+static int same_pt(Pt a, Pt b){
+    return a.x == b.x && a.y == b.y;
+}
+
+// number of segments including the implicit one that closes the loop
+static size_t shape_num_segments(const Shape *s){
+    if (s->len == 0) return 0;
+    if (same_pt(segment_end(&s->segs[s->len-1]), s->segs[0].p[0])) return s->len;
+    return s->len + 1;
+}
+
+// i-th segment, with the closing line synthesised at the end
+static PathSegment shape_segment(const Shape *s, size_t i){
+    if (i < s->len) return s->segs[i];
+    PathSegment closing;
+    closing.type = SEGMENT_LINE;
+    closing.p[0] = segment_end(&s->segs[s->len-1]);
+    closing.p[1] = s->segs[0].p[0];
+    return closing;
+}
+
+// --- parsing ---
+
+static const char *skip_separators(const char *p){
+    while (*p && (isspace((unsigned char)*p) || *p == ',')) p++;
+    return p;
+}
+
+static int read_number(const char **p, double *out){
+    const char *start = skip_separators(*p);
+    char *end = NULL;
+    double v = strtod(start, &end);
+    if (end == start || !isfinite(v)) return 0;
+    *out = v;
+    *p = end;
+    return 1;
+}
+
+// reads an x,y pair, offset by base for relative commands
+static int read_point(const char **p, Pt base, Pt *out){
+    double x, y;
+    if (!read_number(p, &x) || !read_number(p, &y)) return 0;
+    out->x = base.x + x;
+    out->y = base.y + y;
+    return 1;
+}
+
+static int push_line(Shape *s, Pt a, Pt b){
+    PathSegment seg;
+    seg.type = SEGMENT_LINE;
+    seg.p[0] = a;
+    seg.p[1] = b;
+    return shape_push(s, seg);
+}
+
+int svg_parse_path(const char *d, Shape *out){
+    if (!d || !out) return 0;
+
+    Pt cur = {0.0, 0.0};
+    Pt start = {0.0, 0.0};
+    int have_pen = 0;
+    if (out->len > 0){ // appending - carry on from where the last path ended
+        cur = segment_end(&out->segs[out->len-1]);
+        start = cur;
+        have_pen = 1;
+    }
+
+    char cmd = 0;
+    const char *p = d;
+
+    while (1){
+        p = skip_separators(p);
+        if (!*p) break;
+
+        if (isalpha((unsigned char)*p)){
+            cmd = *p++;
+            if (cmd == 'Z' || cmd == 'z'){
+                if (!have_pen) return 0;
+                if (!same_pt(cur, start) && !push_line(out, cur, start)) return 0;
+                cur = start;
+                cmd = 0; // numbers straight after Z aren't valid
+                continue;
+            }
+        } else if (!cmd){
+            return 0; // numbers with no command
+        }
+
+        int relative = islower((unsigned char)cmd);
+        char upper = (char)toupper((unsigned char)cmd);
+        Pt base = cur;
+        if (!relative){
+            base.x = 0.0;
+            base.y = 0.0;
+        }
+
+        if (!have_pen && upper != 'M') return 0; // path has to start with a move
+
+        PathSegment seg;
+        seg.p[0] = cur;
+
+        switch (upper){
+            case 'M': {
+                Pt to;
+                if (!read_point(&p, base, &to)) return 0;
+                // subpaths become one loop, joined by a straight pen-up segment
+                if (have_pen && !same_pt(cur, to) && !push_line(out, cur, to)) return 0;
+                start = to; // Z comes back here
+                cur = to;
+                have_pen = 1;
+                cmd = relative ? 'l' : 'L'; // extra pairs after a move are lines
+                break;
+            }
+            case 'L':
+            case 'H':
+            case 'V': {
+                Pt to = cur;
+                double v;
+                if (upper == 'L'){
+                    if (!read_point(&p, base, &to)) return 0;
+                } else {
+                    if (!read_number(&p, &v)) return 0;
+                    if (upper == 'H') to.x = relative ? cur.x + v : v;
+                    else to.y = relative ? cur.y + v : v;
+                }
+                if (!push_line(out, cur, to)) return 0;
+                cur = to;
+                break;
+            }
+            case 'Q':
+                seg.type = SEGMENT_QUAD;
+                if (!read_point(&p, base, &seg.p[1]) || !read_point(&p, base, &seg.p[2])) return 0;
+                if (!shape_push(out, seg)) return 0;
+                cur = seg.p[2];
+                break;
+            case 'C':
+                seg.type = SEGMENT_CUBIC;
+                if (!read_point(&p, base, &seg.p[1]) || !read_point(&p, base, &seg.p[2])
+                    || !read_point(&p, base, &seg.p[3])) return 0;
+                if (!shape_push(out, seg)) return 0;
+                cur = seg.p[3];
+                break;
+            default:
+                fprintf(stderr, "svg: unsupported path command '%c'\n", cmd);
+                return 0;
+        }
+    }
+    return 1;
+}
+
+// one bad path (eg an arc) shouldn't lose the rest of a big drawing, so it's dropped on its own
+static void load_path(const char *d, Shape *out, const char *filename, int index){
+    size_t before = out->len;
+    if (svg_parse_path(d, out)) return;
+    out->len = before; // segments are plain values, nothing to free
+    fprintf(stderr, "svg: skipping path %d in %s\n", index, filename);
+}
+
+int svg_load_file(const char *filename, Shape *out){
+    FILE *f = fopen(filename, "rb");
+    if (!f) return 0;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0){
+        fclose(f);
+        return 0;
+    }
+
+    char *text = malloc((size_t)size + 1);
+    if (!text){
+        fclose(f);
+        return 0;
+    }
+    size_t got = fread(text, 1, (size_t)size, f);
+    fclose(f);
+    text[got] = '\0';
+
+    // every d="..." attribute - the quotes get overwritten so each path parses in place
+    int found = 0;
+    char *p = text;
+    while ((p = strstr(p, "d=")) != NULL){
+        if (p > text && !isspace((unsigned char)p[-1])){ // eg id="..."
+            p += 2;
+            continue;
+        }
+        p += 2;
+        char quote = *p;
+        if (quote != '"' && quote != '\''){
+            continue;
+        }
+        char *end = strchr(p + 1, quote);
+        if (!end) break;
+        *end = '\0';
+        found++;
+        load_path(p + 1, out, filename, found);
+        p = end + 1;
+    }
+
+    // no attributes - maybe it's just path data
+    if (!found) load_path(text, out, filename, 1);
+
+    free(text);
+    return out->len > 0;
+}
+
+void shape_fit(Shape *s, double size, double margin){
+    if (s->len == 0) return;
+
+    // control points bound the curves, good enough for framing
+    double min_x = DBL_MAX, min_y = DBL_MAX, max_x = -DBL_MAX, max_y = -DBL_MAX;
+    for (size_t i = 0; i < s->len; ++i){
+        for (int j = 0; j <= (int)s->segs[i].type; ++j){
+            Pt q = s->segs[i].p[j];
+            if (q.x < min_x) min_x = q.x;
+            if (q.y < min_y) min_y = q.y;
+            if (q.x > max_x) max_x = q.x;
+            if (q.y > max_y) max_y = q.y;
+        }
+    }
+
+    double extent = fmax(max_x - min_x, max_y - min_y);
+    double scale = extent > DBL_EPSILON ? (size - 2.0 * margin) / extent : 1.0;
+    double mid_x = 0.5 * (min_x + max_x);
+    double mid_y = 0.5 * (min_y + max_y);
+
+    for (size_t i = 0; i < s->len; ++i){
+        for (int j = 0; j <= (int)s->segs[i].type; ++j){
+            Pt *q = &s->segs[i].p[j];
+            q->x = 0.5 * size + (q->x - mid_x) * scale;
+            q->y = 0.5 * size + (q->y - mid_y) * scale;
+        }
+    }
+}
+
+// --- analytic coefficients ---
+
+// rewrites bernstein control points as z(u) = sum_m poly[m] u^m, returns the degree
+static int segment_poly(const PathSegment *seg, complex_t poly[4]){
+    complex_t p[4];
+    for (int j = 0; j <= (int)seg->type; ++j) p[j] = c_make(seg->p[j].x, seg->p[j].y);
+
+    poly[0] = p[0];
+    switch (seg->type){
+        case SEGMENT_LINE:
+            poly[1] = c_sub(p[1], p[0]);
+            return 1;
+        case SEGMENT_QUAD:
+            poly[1] = c_scale(c_sub(p[1], p[0]), 2.0);
+            poly[2] = c_add(c_sub(p[0], c_scale(p[1], 2.0)), p[2]);
+            return 2;
+        case SEGMENT_CUBIC:
+        default:
+            poly[1] = c_scale(c_sub(p[1], p[0]), 3.0);
+            poly[2] = c_scale(c_add(c_sub(p[0], c_scale(p[1], 2.0)), p[2]), 3.0);
+            poly[3] = c_add(c_sub(c_scale(c_sub(p[1], p[2]), 3.0), p[0]), p[3]);
+            return 3;
+    }
+}
+
+// parameter time given to a segment - exact for lines, (chord + control net) / 2 for curves
+static double segment_length(const PathSegment *seg){
+    int degree = (int)seg->type;
+    double chord = hypot(seg->p[degree].x - seg->p[0].x, seg->p[degree].y - seg->p[0].y);
+    if (degree == 1) return chord;
+    double net = 0.0;
+    for (int j = 1; j <= degree; ++j){
+        net += hypot(seg->p[j].x - seg->p[j-1].x, seg->p[j].y - seg->p[j-1].y);
+    }
+    return 0.5 * (chord + net);
+}
+
+// moments I_m = int_0^1 u^m e^{s u} du for m = 0..degree
+// power series when |s| is small (the recurrence cancels badly there), recurrence otherwise
+static void exp_moments(complex_t s, int degree, complex_t *moments){
+    double mag = hypot(s.re, s.im);
+    if (mag < 1.0){
+        for (int m = 0; m <= degree; ++m){
+            complex_t sum = c_make(0.0, 0.0);
+            complex_t term = c_make(1.0, 0.0); // s^n / n!
+            for (int n = 0; n < SERIES_TERMS; ++n){
+                sum = c_add(sum, c_scale(term, 1.0 / (double)(m + n + 1)));
+                term = c_scale(c_mul(term, s), 1.0 / (double)(n + 1));
+            }
+            moments[m] = sum;
+        }
+        return;
+    }
+
+    complex_t es = c_exp(s);
+    moments[0] = c_div(c_sub(es, c_make(1.0, 0.0)), s);
+    for (int m = 1; m <= degree; ++m){
+        moments[m] = c_div(c_sub(es, c_scale(moments[m-1], (double)m)), s);
+    }
+}
+
+int shape_descriptors(const Shape *s, int K, complex_t *output){
+    if (!s || !output || K < 0) return 0;
+
+    size_t num_segs = shape_num_segments(s);
+    double total_length = 0.0;
+    for (size_t i = 0; i < num_segs; ++i){
+        PathSegment seg = shape_segment(s, i);
+        total_length += segment_length(&seg);
+    }
+    if (total_length < DBL_EPSILON) return 0;
+
+    for (int i = 0; i < 2 * K + 1; ++i){
+        output[i] = c_make(0.0, 0.0);
+    }
+
+    // c_k = 1/T int z(t) e^{-i w t} dt, w = 2 pi k / T
+    // on a segment starting at t0 lasting dt with t = t0 + u dt that's
+    // dt/T e^{-i w t0} sum_m poly[m] I_m(-i w dt)
+    double t0 = 0.0;
+    for (size_t i = 0; i < num_segs; ++i){
+        PathSegment seg = shape_segment(s, i);
+        double dt = segment_length(&seg);
+        if (dt < DBL_EPSILON) continue;
+
+        complex_t poly[4];
+        complex_t moments[4];
+        int degree = segment_poly(&seg, poly);
+
+        for (int k = -K; k <= K; ++k){
+            double w = 2.0 * M_PI * (double)k / total_length;
+            exp_moments(c_make(0.0, -w * dt), degree, moments);
+
+            complex_t integral = c_make(0.0, 0.0);
+            for (int m = 0; m <= degree; ++m){
+                integral = c_add(integral, c_mul(poly[m], moments[m]));
+            }
+
+            complex_t phase = c_make(cos(w * t0), -sin(w * t0));
+            output[k+K] = c_add(output[k+K], c_scale(c_mul(phase, integral), dt / total_length));
+        }
+        t0 += dt;
+    }
+    return 1;
+}
+
+int shape_outline(const Shape *s, size_t num_per_segment, Pt **pts_out, size_t *num_out){
+    size_t num_segs = shape_num_segments(s);
+    if (num_segs == 0 || num_per_segment == 0) return 0;
+
+    Pt *pts = malloc(sizeof(Pt) * num_segs * num_per_segment);
+    if (!pts) return 0;
+
+    size_t n = 0;
+    for (size_t i = 0; i < num_segs; ++i){
+        PathSegment seg = shape_segment(s, i);
+        complex_t poly[4];
+        int degree = segment_poly(&seg, poly);
+        size_t steps = degree == 1 ? 1 : num_per_segment; // lines only need their start point
+
+        for (size_t j = 0; j < steps; ++j){
+            double u = (double)j / (double)steps;
+            complex_t z = poly[degree];
+            for (int m = degree - 1; m >= 0; --m){ // horner
+                z = c_add(c_scale(z, u), poly[m]);
+            }
+            pts[n].x = z.re;
+            pts[n].y = z.im;
+            n++;
+        }
+    }
+
+    *pts_out = pts;
+    *num_out = n;
+    return 1;
+}
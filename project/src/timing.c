@@ -0,0 +1,11 @@
+#define _POSIX_C_SOURCE 199309L // clock_gettime - kept in its own file so it doesn't hide M_PI elsewhere
+
+#include "timing.h"
+
+#include <time.h>
+
+double now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1.0e6;
+}
@@ -0,0 +1,164 @@
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_HEADER_SIZE 8
+#define TRACE_RECORD_SIZE 10
+
+static const char TRACE_MAGIC[4] = {'F', 'T', 'R', 'C'};
+
+// explicit little endian so traces move between machines
+static void put_u16(uint8_t *p, uint16_t v){
+    p[0] = (uint8_t)(v & 0xff);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v){
+    for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *p){
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p){
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int trace_recorder_open(TraceRecorder *tr, const char *filename){
+    tr->f = fopen(filename, "wb");
+    tr->start_ms = 0;
+    tr->count = 0;
+    if (!tr->f) return 0;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, 4);
+    put_u32(header + 4, TRACE_VERSION);
+    if (fwrite(header, 1, TRACE_HEADER_SIZE, tr->f) != TRACE_HEADER_SIZE){
+        fclose(tr->f);
+        tr->f = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+int trace_record(TraceRecorder *tr, const SDL_Event *e){
+    if (!tr->f) return 0;
+
+    TraceEvent te;
+    Uint32 timestamp;
+    switch (e->type){
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            te.type = e->type == SDL_MOUSEBUTTONDOWN ? TRACE_MOUSE_DOWN : TRACE_MOUSE_UP;
+            te.button = e->button.button;
+            te.x = (int16_t)e->button.x;
+            te.y = (int16_t)e->button.y;
+            timestamp = e->button.timestamp;
+            break;
+        case SDL_MOUSEMOTION:
+            te.type = TRACE_MOUSE_MOTION;
+            te.button = 0;
+            te.x = (int16_t)e->motion.x;
+            te.y = (int16_t)e->motion.y;
+            timestamp = e->motion.timestamp;
+            break;
+        default:
+            return 1; // not ours
+    }
+
+    if (tr->count == 0) tr->start_ms = timestamp;
+    te.time_ms = timestamp - tr->start_ms;
+
+    uint8_t rec[TRACE_RECORD_SIZE];
+    rec[0] = te.type;
+    rec[1] = te.button;
+    put_u16(rec + 2, (uint16_t)te.x);
+    put_u16(rec + 4, (uint16_t)te.y);
+    put_u32(rec + 6, te.time_ms);
+    if (fwrite(rec, 1, TRACE_RECORD_SIZE, tr->f) != TRACE_RECORD_SIZE) return 0;
+
+    tr->count++;
+    return 1;
+}
+
+void trace_recorder_close(TraceRecorder *tr){
+    if (tr->f) fclose(tr->f);
+    tr->f = NULL;
+}
+
+int trace_load(const char *filename, Trace *out){
+    out->events = NULL;
+    out->len = 0;
+
+    FILE *f = fopen(filename, "rb");
+    if (!f) return 0;
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (fread(header, 1, TRACE_HEADER_SIZE, f) != TRACE_HEADER_SIZE
+        || memcmp(header, TRACE_MAGIC, 4) != 0
+        || get_u32(header + 4) != TRACE_VERSION){
+        fclose(f);
+        return 0;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, TRACE_HEADER_SIZE, SEEK_SET);
+    size_t num_events = size > TRACE_HEADER_SIZE ? (size_t)(size - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE : 0;
+
+    TraceEvent *events = malloc(sizeof(TraceEvent) * (num_events ? num_events : 1));
+    if (!events){
+        fclose(f);
+        return 0;
+    }
+
+    uint8_t rec[TRACE_RECORD_SIZE];
+    size_t n = 0;
+    while (n < num_events && fread(rec, 1, TRACE_RECORD_SIZE, f) == TRACE_RECORD_SIZE){
+        events[n].type = rec[0];
+        events[n].button = rec[1];
+        events[n].x = (int16_t)get_u16(rec + 2);
+        events[n].y = (int16_t)get_u16(rec + 4);
+        events[n].time_ms = get_u32(rec + 6);
+        if (n > 0 && events[n].time_ms < events[n-1].time_ms){ // replay assumes time only moves forward
+            free(events);
+            fclose(f);
+            return 0;
+        }
+        n++;
+    }
+    fclose(f);
+
+    out->events = events;
+    out->len = n;
+    return 1;
+}
+
+void trace_free(Trace *t){
+    free(t->events);
+    t->events = NULL;
+    t->len = 0;
+}
+
+void trace_to_sdl_event(const TraceEvent *te, SDL_Event *out){
+    memset(out, 0, sizeof(*out));
+    switch (te->type){
+        case TRACE_MOUSE_DOWN:
+        case TRACE_MOUSE_UP:
+            out->type = te->type == TRACE_MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+            out->button.timestamp = te->time_ms;
+            out->button.button = te->button;
+            out->button.x = te->x;
+            out->button.y = te->y;
+            break;
+        case TRACE_MOUSE_MOTION:
+        default:
+            out->type = SDL_MOUSEMOTION;
+            out->motion.timestamp = te->time_ms;
+            out->motion.x = te->x;
+            out->motion.y = te->y;
+            break;
+    }
+}